@@ -155,6 +155,7 @@ void BouncingBallsState::createWall(sf::Vector2f start, sf::Vector2f vec)
 
     auto collider = world.attachComponent<ECSE::LineColliderComponent>(id);
     collider->vec = vec;
+    collider->isStatic = true;
 
     world.registerEntity(id);
 }
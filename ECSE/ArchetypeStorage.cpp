@@ -0,0 +1,130 @@
+#include "ArchetypeStorage.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace ECSE
+{
+
+const size_t ArchetypeStorage::chunkBytes;
+const size_t ArchetypeStorage::noArchetype;
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+    // Rows are raw memory, so the Components still in them have to be destroyed by hand
+    for (auto& archetype : archetypes)
+    {
+        for (Entity* entity : archetype.entities)
+        {
+            if (!entity) continue;
+
+            entity->forEachDistinctComponent([](Component* component)
+            {
+                component->~Component();
+            });
+
+            entity->archetype = Entity::noArchetype;
+        }
+    }
+}
+
+size_t ArchetypeStorage::findArchetype(const ComponentMask& mask) const
+{
+    auto it = directory.find(mask);
+    if (it == directory.end())
+    {
+        return noArchetype;
+    }
+
+    return it->second;
+}
+
+size_t ArchetypeStorage::addArchetype(const ComponentMask& mask, const std::vector<Column>& columns)
+{
+    Archetype archetype;
+    archetype.mask = mask;
+
+    // Work out how many rows fit in a chunk, leaving room for padding between the arrays
+    size_t rowSize = 0;
+    size_t padding = 0;
+    for (const auto& column : columns)
+    {
+        if (column.alignment > alignof(std::max_align_t))
+        {
+            std::stringstream ss;
+            ss << "Component type " << column.typeID << " is over-aligned (" << column.alignment
+               << " bytes) and can't be stored by archetype";
+
+            throw std::runtime_error(ss.str());
+        }
+
+        rowSize += column.size;
+        padding += column.alignment - 1;
+    }
+
+    archetype.capacity = std::max<size_t>(1, (chunkBytes - std::min(chunkBytes, padding)) / std::max<size_t>(1, rowSize));
+
+    // Lay the arrays out one after another, each aligned for its type
+    size_t offset = 0;
+    for (const auto& column : columns)
+    {
+        offset = (offset + column.alignment - 1) / column.alignment * column.alignment;
+        archetype.offsets.push_back(offset);
+        archetype.sizes.push_back(column.size);
+        offset += column.size * archetype.capacity;
+    }
+    archetype.chunkSize = std::max<size_t>(1, offset);
+
+    archetypes.push_back(std::move(archetype));
+    directory[mask] = archetypes.size() - 1;
+
+    return archetypes.size() - 1;
+}
+
+void ArchetypeStorage::insert(Entity& entity, size_t archetypeIndex)
+{
+    Archetype& archetype = archetypes[archetypeIndex];
+
+    size_t row;
+    if (!archetype.freeRows.empty())
+    {
+        row = archetype.freeRows.back();
+        archetype.freeRows.pop_back();
+        archetype.entities[row] = &entity;
+    }
+    else
+    {
+        row = archetype.entities.size();
+        if (row == archetype.chunks.size() * archetype.capacity)
+        {
+            archetype.chunks.emplace_back(new unsigned char[archetype.chunkSize]);
+        }
+
+        archetype.entities.push_back(&entity);
+    }
+
+    entity.archetype = archetypeIndex;
+    entity.row = row;
+}
+
+void* ArchetypeStorage::getSlot(const Entity& entity, size_t typeID) const
+{
+    const Archetype& archetype = archetypes[entity.archetype];
+    size_t chunk = entity.row / archetype.capacity;
+    size_t index = entity.row % archetype.capacity;
+
+    size_t column = (archetype.mask << (maxComponentTypes - typeID)).count();
+
+    return archetype.chunks[chunk].get() + archetype.offsets[column] + index * archetype.sizes[column];
+}
+
+void ArchetypeStorage::erase(Entity& entity)
+{
+    Archetype& archetype = archetypes[entity.archetype];
+
+    archetype.entities[entity.row] = nullptr;
+    archetype.freeRows.push_back(entity.row);
+
+    entity.archetype = Entity::noArchetype;
+}
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ComponentType.h"
+#include "Entity.h"
+
+namespace ECSE
+{
+
+//! Stores Components in chunks, grouped by the set of Component types their Entity has.
+/*!
+* Each distinct set of concrete Component types (an archetype) gets a table. The table is split into
+* fixed-size chunks, and within a chunk each Component type has its own contiguous array, so iterating
+* a few types streams linearly through memory instead of chasing pointers.
+*
+* Rows don't move once they're filled, so pointers to stored Components stay valid until their Entity
+* is destroyed. Freed rows are reused by the next Entity with the same archetype.
+*/
+class ArchetypeStorage
+{
+public:
+    //! Describes the Components of one type stored in an archetype.
+    struct Column
+    {
+        size_t typeID;      //!< The concrete Component type ID.
+        size_t size;        //!< The size of a Component of this type.
+        size_t alignment;   //!< The alignment of a Component of this type.
+    };
+
+    //! The approximate size of each chunk in bytes.
+    static const size_t chunkBytes = 16384;
+
+    //! Value for an archetype that hasn't been made yet.
+    static const size_t noArchetype = static_cast<size_t>(-1);
+
+    //! Destroy the storage, along with any Components still stored in it.
+    ~ArchetypeStorage();
+
+    //! Find the archetype for a set of concrete Component types.
+    /*!
+    * \param mask The concrete Component types.
+    * \return The archetype's index, or noArchetype if there isn't one yet.
+    */
+    size_t findArchetype(const ComponentMask& mask) const;
+
+    //! Add the archetype for a set of concrete Component types.
+    /*!
+    * \param mask The concrete Component types.
+    * \param columns A column for each type in mask, in type ID order.
+    * \return The new archetype's index.
+    */
+    size_t addArchetype(const ComponentMask& mask, const std::vector<Column>& columns);
+
+    //! Reserve a row for an Entity.
+    /*!
+    * The Entity's Components must be moved into the row's slots afterward with getSlot().
+    *
+    * \param entity The Entity.
+    * \param archetype The index of the Entity's archetype.
+    */
+    void insert(Entity& entity, size_t archetype);
+
+    //! Get the address of a Component's slot in an Entity's row.
+    /*!
+    * \param entity The stored Entity.
+    * \param typeID The concrete Component type ID.
+    * \return The address of the slot.
+    */
+    void* getSlot(const Entity& entity, size_t typeID) const;
+
+    //! Free an Entity's row.
+    /*!
+    * The Components in the row must have been destroyed already.
+    *
+    * \param entity The stored Entity.
+    */
+    void erase(Entity& entity);
+
+    //! Get the number of archetypes.
+    /*!
+    * \return The number of archetypes.
+    */
+    inline size_t getArchetypeCount() const
+    {
+        return archetypes.size();
+    }
+
+    //! Call a function for every stored Entity which has Components of all the given types.
+    /*!
+    * The types must be the concrete types of the Components, since each column only holds one type.
+    * Components are visited in row order, which is the order their Entities were stored in, apart
+    * from reused rows.
+    *
+    * \tparam ComponentTypes The concrete Component types.
+    * \param fn The function to call, as fn(Entity&, ComponentTypes&...).
+    */
+    template <typename... ComponentTypes, typename Function>
+    void forEach(Function fn);
+
+private:
+    //! A table of Entities with the same set of concrete Component types.
+    struct Archetype
+    {
+        //! Get the byte offset of a type's array within each chunk.
+        /*!
+        * \param typeID The concrete Component type ID, which must be in mask.
+        * \return The offset.
+        */
+        inline size_t getOffset(size_t typeID) const
+        {
+            return offsets[(mask << (maxComponentTypes - typeID)).count()];
+        }
+
+        ComponentMask mask;                                     //!< The concrete Component types.
+        std::vector<size_t> offsets;                            //!< Offset of each type's array, in type ID order.
+        std::vector<size_t> sizes;                              //!< Size of each type, in type ID order.
+        size_t capacity;                                        //!< The number of rows in each chunk.
+        size_t chunkSize;                                       //!< The size of each chunk in bytes.
+        std::vector<std::unique_ptr<unsigned char[]>> chunks;   //!< The chunks.
+        std::vector<Entity*> entities;                          //!< The Entity in each row, or nullptr if it's free.
+        std::vector<size_t> freeRows;                           //!< Rows which have been freed.
+    };
+
+    //! Call a function for every filled row of an archetype.
+    /*!
+    * \param archetype The archetype.
+    * \param offsets The byte offset of each type's array.
+    * \param fn The function to call.
+    */
+    template <typename... ComponentTypes, typename Function, size_t... Indices>
+    static void forEachRow(const Archetype& archetype, const size_t* offsets, Function& fn,
+                           std::index_sequence<Indices...>);
+
+    std::vector<Archetype> archetypes;                      //!< The archetypes.
+    std::unordered_map<ComponentMask, size_t> directory;    //!< Map from concrete types to archetype index.
+};
+
+/////////////////
+// Implementation
+
+template <typename... ComponentTypes, typename Function>
+void ArchetypeStorage::forEach(Function fn)
+{
+    static_assert(sizeof...(ComponentTypes) > 0, "forEach needs at least one Component type!");
+
+    ComponentMask required;
+    for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+    {
+        required.set(typeID);
+    }
+
+    for (const auto& archetype : archetypes)
+    {
+        if ((archetype.mask & required) != required) continue;
+
+        size_t offsets[] = { archetype.getOffset(ComponentTypeRegistry::getID<ComponentTypes>())... };
+        forEachRow<ComponentTypes...>(archetype, offsets, fn, std::index_sequence_for<ComponentTypes...>());
+    }
+}
+
+template <typename... ComponentTypes, typename Function, size_t... Indices>
+void ArchetypeStorage::forEachRow(const Archetype& archetype, const size_t* offsets, Function& fn,
+                                  std::index_sequence<Indices...>)
+{
+    for (size_t chunk = 0; chunk < archetype.chunks.size(); ++chunk)
+    {
+        unsigned char* data = archetype.chunks[chunk].get();
+        size_t first = chunk * archetype.capacity;
+        size_t end = std::min(first + archetype.capacity, archetype.entities.size());
+
+        for (size_t row = first; row < end; ++row)
+        {
+            Entity* entity = archetype.entities[row];
+            if (!entity) continue;
+
+            fn(*entity, reinterpret_cast<ComponentTypes*>(data + offsets[Indices])[row - first]...);
+        }
+    }
+}
+
+}
@@ -0,0 +1,366 @@
+#include "BatchCollisionMath.h"
+#include "CollisionMath.h"
+
+#if !defined(ECSE_NO_SIMD)
+#if defined(__AVX__)
+#define ECSE_BATCH_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ECSE_BATCH_SSE
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace ECSE
+{
+
+size_t CircleCircleBatch::add(sf::Vector2f centerA, float radiusA, sf::Vector2f centerB, float radiusB,
+                              sf::Vector2f velocity)
+{
+    centerAX.push_back(centerA.x);
+    centerAY.push_back(centerA.y);
+    this->radiusA.push_back(radiusA);
+    centerBX.push_back(centerB.x);
+    centerBY.push_back(centerB.y);
+    this->radiusB.push_back(radiusB);
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+
+    return size() - 1;
+}
+
+void CircleCircleBatch::clear()
+{
+    centerAX.clear();
+    centerAY.clear();
+    radiusA.clear();
+    centerBX.clear();
+    centerBY.clear();
+    radiusB.clear();
+    velocityX.clear();
+    velocityY.clear();
+    time.clear();
+    normalX.clear();
+    normalY.clear();
+}
+
+size_t CircleLineBatch::add(sf::Vector2f centerA, float radiusA, sf::Vector2f startB, sf::Vector2f endB,
+                            sf::Vector2f velocity)
+{
+    centerX.push_back(centerA.x);
+    centerY.push_back(centerA.y);
+    radius.push_back(radiusA);
+    startX.push_back(startB.x);
+    startY.push_back(startB.y);
+    endX.push_back(endB.x);
+    endY.push_back(endB.y);
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+
+    return size() - 1;
+}
+
+void CircleLineBatch::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    radius.clear();
+    startX.clear();
+    startY.clear();
+    endX.clear();
+    endY.clear();
+    velocityX.clear();
+    velocityY.clear();
+    time.clear();
+    normalX.clear();
+    normalY.clear();
+}
+
+//! Solve a single circle-circle collision in a batch with the scalar function.
+static void solveScalar(CircleCircleBatch& batch, size_t i)
+{
+    sf::Vector2f normal;
+    circleCircle(sf::Vector2f(batch.centerAX[i], batch.centerAY[i]), batch.radiusA[i],
+                 sf::Vector2f(batch.centerBX[i], batch.centerBY[i]), batch.radiusB[i],
+                 sf::Vector2f(batch.velocityX[i], batch.velocityY[i]), batch.time[i], normal);
+
+    batch.normalX[i] = normal.x;
+    batch.normalY[i] = normal.y;
+}
+
+//! Solve a single circle-line collision in a batch with the scalar function.
+static void solveScalar(CircleLineBatch& batch, size_t i)
+{
+    sf::Vector2f normal;
+    circleLine(sf::Vector2f(batch.centerX[i], batch.centerY[i]), batch.radius[i],
+               sf::Vector2f(batch.startX[i], batch.startY[i]), sf::Vector2f(batch.endX[i], batch.endY[i]),
+               sf::Vector2f(batch.velocityX[i], batch.velocityY[i]), batch.time[i], normal);
+
+    batch.normalX[i] = normal.x;
+    batch.normalY[i] = normal.y;
+}
+
+#if defined(ECSE_BATCH_AVX) || defined(ECSE_BATCH_SSE)
+
+// Thin wrappers so that the kernels below can be written once for both SSE and AVX.
+// A Mask has every bit set in lanes where a comparison was true.
+
+#if defined(ECSE_BATCH_AVX)
+
+struct Pack { __m256 v; };
+struct Mask { __m256 v; };
+
+static const size_t packWidth = 8;
+
+static inline Pack load(const float* p) { return { _mm256_loadu_ps(p) }; }
+static inline void store(float* p, Pack a) { _mm256_storeu_ps(p, a.v); }
+static inline Pack set(float f) { return { _mm256_set1_ps(f) }; }
+
+static inline Pack operator+(Pack a, Pack b) { return { _mm256_add_ps(a.v, b.v) }; }
+static inline Pack operator-(Pack a, Pack b) { return { _mm256_sub_ps(a.v, b.v) }; }
+static inline Pack operator*(Pack a, Pack b) { return { _mm256_mul_ps(a.v, b.v) }; }
+static inline Pack operator/(Pack a, Pack b) { return { _mm256_div_ps(a.v, b.v) }; }
+static inline Pack sqrt(Pack a) { return { _mm256_sqrt_ps(a.v) }; }
+
+static inline Mask operator<(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+static inline Mask operator<=(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+static inline Mask operator>(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+static inline Mask operator>=(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+static inline Mask operator==(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+
+static inline Mask operator&(Mask a, Mask b) { return { _mm256_and_ps(a.v, b.v) }; }
+static inline Mask operator|(Mask a, Mask b) { return { _mm256_or_ps(a.v, b.v) }; }
+static inline Mask operator!(Mask a) { return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+static inline Pack select(Mask m, Pack a, Pack b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+static inline int toBits(Mask m) { return _mm256_movemask_ps(m.v); }
+
+#else
+
+struct Pack { __m128 v; };
+struct Mask { __m128 v; };
+
+static const size_t packWidth = 4;
+
+static inline Pack load(const float* p) { return { _mm_loadu_ps(p) }; }
+static inline void store(float* p, Pack a) { _mm_storeu_ps(p, a.v); }
+static inline Pack set(float f) { return { _mm_set1_ps(f) }; }
+
+static inline Pack operator+(Pack a, Pack b) { return { _mm_add_ps(a.v, b.v) }; }
+static inline Pack operator-(Pack a, Pack b) { return { _mm_sub_ps(a.v, b.v) }; }
+static inline Pack operator*(Pack a, Pack b) { return { _mm_mul_ps(a.v, b.v) }; }
+static inline Pack operator/(Pack a, Pack b) { return { _mm_div_ps(a.v, b.v) }; }
+static inline Pack sqrt(Pack a) { return { _mm_sqrt_ps(a.v) }; }
+
+static inline Mask operator<(Pack a, Pack b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+static inline Mask operator<=(Pack a, Pack b) { return { _mm_cmple_ps(a.v, b.v) }; }
+static inline Mask operator>(Pack a, Pack b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+static inline Mask operator>=(Pack a, Pack b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+static inline Mask operator==(Pack a, Pack b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+
+static inline Mask operator&(Mask a, Mask b) { return { _mm_and_ps(a.v, b.v) }; }
+static inline Mask operator|(Mask a, Mask b) { return { _mm_or_ps(a.v, b.v) }; }
+static inline Mask operator!(Mask a) { return { _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+static inline Pack select(Mask m, Pack a, Pack b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+static inline int toBits(Mask m) { return _mm_movemask_ps(m.v); }
+
+#endif
+
+//! Normalize a vector, leaving it alone if it has no length (like ECSE::normalize).
+static inline void normalize(Pack& x, Pack& y)
+{
+    Pack magnitude = sqrt(x * x + y * y);
+    Mask nonZero = magnitude > set(0.f);
+
+    x = select(nonZero, x / magnitude, x);
+    y = select(nonZero, y / magnitude, y);
+}
+
+//! Solve packWidth circle-circle collisions starting at i.
+/*!
+* This mirrors circleCircle step by step, with each early return replaced by clearing a lane's hit mask.
+*/
+static void solvePack(CircleCircleBatch& batch, size_t i)
+{
+    Pack centerAX = load(&batch.centerAX[i]);
+    Pack centerAY = load(&batch.centerAY[i]);
+    Pack centerBX = load(&batch.centerBX[i]);
+    Pack centerBY = load(&batch.centerBY[i]);
+    Pack velocityX = load(&batch.velocityX[i]);
+    Pack velocityY = load(&batch.velocityY[i]);
+
+    Pack distX = centerBX - centerAX;
+    Pack distY = centerBY - centerAY;
+    Pack sumRadii = load(&batch.radiusA[i]) + load(&batch.radiusB[i]);
+    Pack sumRadiiSqr = sumRadii * sumRadii;
+    Pack distSqr = distX * distX + distY * distY;
+
+    // Already colliding
+    Mask colliding = (sumRadiiSqr - distSqr) > set(collisionFudgeSqr);
+
+    Pack centerDist = sqrt(distSqr);
+    Pack moveDist = sqrt(velocityX * velocityX + velocityY * velocityY);
+
+    // Moving far enough to close the distance
+    Mask hit = !(moveDist < centerDist - sumRadii);
+
+    Pack moveNormalX = velocityX;
+    Pack moveNormalY = velocityY;
+    normalize(moveNormalX, moveNormalY);
+
+    // Moving toward each other
+    Pack towardDist = moveNormalX * distX + moveNormalY * distY;
+    hit = hit & (towardDist > set(0.f));
+
+    // Getting close enough to collide
+    Pack shortestDistSqr = centerDist * centerDist - towardDist * towardDist;
+    hit = hit & (shortestDistSqr < sumRadiiSqr);
+
+    Pack thirdSideSqr = sumRadiiSqr - shortestDistSqr;
+    hit = hit & !(thirdSideSqr < set(0.f));
+
+    // Moving far enough to collide
+    Pack collideDist = towardDist - sqrt(thirdSideSqr);
+    hit = hit & !(moveDist < collideDist);
+
+    Pack time = select(colliding, set(0.f), select(hit, collideDist / moveDist, set(-1.f)));
+
+    Pack normalX = centerBX - (centerAX + velocityX * time);
+    Pack normalY = centerBY - (centerAY + velocityY * time);
+    normalize(normalX, normalY);
+
+    store(&batch.time[i], time);
+    store(&batch.normalX[i], normalX);
+    store(&batch.normalY[i], normalY);
+}
+
+//! Solve packWidth circle-line collisions starting at i.
+/*!
+* This mirrors the common paths through circleLine. Lanes which end up testing against an endpoint
+* are rare and branchy, so those are re-solved with circleLine itself.
+*/
+static void solvePack(CircleLineBatch& batch, size_t i)
+{
+    Pack centerX = load(&batch.centerX[i]);
+    Pack centerY = load(&batch.centerY[i]);
+    Pack radius = load(&batch.radius[i]);
+    Pack startX = load(&batch.startX[i]);
+    Pack startY = load(&batch.startY[i]);
+    Pack velocityX = load(&batch.velocityX[i]);
+    Pack velocityY = load(&batch.velocityY[i]);
+
+    // Find closest point on line to circle
+    Pack lineX = load(&batch.endX[i]) - startX;
+    Pack lineY = load(&batch.endY[i]) - startY;
+    Pack lineSqr = lineX * lineX + lineY * lineY;
+    Pack t = ((centerX - startX) * lineX + (centerY - startY) * lineY) / lineSqr;
+    Pack closeX = startX + lineX * t;
+    Pack closeY = startY + lineY * t;
+
+    Pack toLineX = closeX - centerX;
+    Pack toLineY = closeY - centerY;
+    Pack distSqr = toLineX * toLineX + toLineY * toLineY;
+
+    Pack lineNormalX = toLineX;
+    Pack lineNormalY = toLineY;
+    normalize(lineNormalX, lineNormalY);
+
+    // Circle is already touching the line
+    Mask touching = (distSqr + set(collisionFudgeSqr) < radius * radius) & (t >= set(0.f)) & (t <= set(1.f));
+
+    // Circle is moving parallel to line, so it can only hit an endpoint
+    Pack endX = centerX + velocityX;
+    Pack endY = centerY + velocityY;
+    Pack moveX = endX - centerX;
+    Pack moveY = endY - centerY;
+    Mask parallel = (lineX * moveY - lineY * moveX) == set(0.f);
+
+    // Circle's velocity towards the nearest point on the line
+    Pack projection = (velocityX * lineNormalX + velocityY * lineNormalY) /
+                      (lineNormalX * lineNormalX + lineNormalY * lineNormalY);
+    Pack towardX = projection * lineNormalX;
+    Pack towardY = projection * lineNormalY;
+    Pack speedTowardLine = sqrt(towardX * towardX + towardY * towardY);
+
+    // Circle will not move close enough to the line
+    Pack distMinusRadius = sqrt(distSqr) - radius;
+    Mask tooSlow = speedTowardLine < distMinusRadius;
+
+    Pack time = distMinusRadius / speedTowardLine;
+
+    // The distance along the line segment of the point of intersection
+    Pack endT = ((endX - startX) * lineX + (endY - startY) * lineY) / lineSqr;
+    Pack intersectT = t + (endT - t) * time;
+
+    // Point of intersection is within segment bounds and we're not moving away from the line
+    Mask hit = (intersectT >= set(0.f)) & (intersectT <= set(1.f)) &
+               (towardX * toLineX + towardY * toLineY >= set(0.f));
+
+    time = select(touching, set(0.f), select(tooSlow, set(-1.f), time));
+
+    store(&batch.time[i], time);
+    store(&batch.normalX[i], lineNormalX);
+    store(&batch.normalY[i], lineNormalY);
+
+    // Everything else might hit an endpoint
+    Mask resolved = touching | ((!parallel) & (tooSlow | hit));
+    int fallback = toBits(!resolved);
+
+    for (size_t lane = 0; fallback != 0; ++lane, fallback >>= 1)
+    {
+        if (fallback & 1) solveScalar(batch, i + lane);
+    }
+}
+
+#else
+
+static const size_t packWidth = 1;
+
+static inline void solvePack(CircleCircleBatch& batch, size_t i)
+{
+    solveScalar(batch, i);
+}
+
+static inline void solvePack(CircleLineBatch& batch, size_t i)
+{
+    solveScalar(batch, i);
+}
+
+#endif
+
+//! Solve a batch a pack at a time, finishing off the remainder one at a time.
+template <typename Batch>
+static void solveAll(Batch& batch)
+{
+    size_t count = batch.size();
+    batch.time.resize(count);
+    batch.normalX.resize(count);
+    batch.normalY.resize(count);
+
+    size_t i = 0;
+    for (; i + packWidth <= count; i += packWidth)
+    {
+        solvePack(batch, i);
+    }
+
+    for (; i < count; ++i)
+    {
+        solveScalar(batch, i);
+    }
+}
+
+void solveBatch(CircleCircleBatch& batch)
+{
+    solveAll(batch);
+}
+
+void solveBatch(CircleLineBatch& batch)
+{
+    solveAll(batch);
+}
+
+size_t getBatchWidth()
+{
+    return packWidth;
+}
+
+}
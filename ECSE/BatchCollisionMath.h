@@ -0,0 +1,123 @@
+//! \file BatchCollisionMath.h Contains functions for solving many collisions at once.
+/*!
+* These give the same results as circleCircle and circleLine in CollisionMath.h, but work on
+* structure-of-arrays batches so that several pairs can be solved per instruction with SSE or AVX.
+* Define ECSE_NO_SIMD to always use the scalar functions.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+namespace ECSE
+{
+
+//! A batch of collisions between moving circles and stationary circles.
+struct CircleCircleBatch
+{
+    std::vector<float> centerAX;    //!< The X position of each first circle.
+    std::vector<float> centerAY;    //!< The Y position of each first circle.
+    std::vector<float> radiusA;     //!< The radius of each first circle.
+    std::vector<float> centerBX;    //!< The X position of each second circle.
+    std::vector<float> centerBY;    //!< The Y position of each second circle.
+    std::vector<float> radiusB;     //!< The radius of each second circle.
+    std::vector<float> velocityX;   //!< The X velocity of each first circle.
+    std::vector<float> velocityY;   //!< The Y velocity of each first circle.
+
+    std::vector<float> time;        //!< Output time of each collision, or <0 if no collision.
+    std::vector<float> normalX;     //!< Output X normal of each collision. Meaningless if no collision.
+    std::vector<float> normalY;     //!< Output Y normal of each collision. Meaningless if no collision.
+
+    //! Add a collision to the batch.
+    /*!
+    * See circleCircle for the meaning of each parameter.
+    * \return The index of the collision in the batch.
+    */
+    size_t add(sf::Vector2f centerA, float radiusA, sf::Vector2f centerB, float radiusB, sf::Vector2f velocity);
+
+    //! Remove every collision from the batch.
+    void clear();
+
+    //! Get the number of collisions in the batch.
+    inline size_t size() const
+    {
+        return centerAX.size();
+    }
+
+    //! Get the output normal of a collision.
+    /*!
+    * \param i The index of the collision.
+    * \return The normal.
+    */
+    inline sf::Vector2f getNormal(size_t i) const
+    {
+        return sf::Vector2f(normalX[i], normalY[i]);
+    }
+};
+
+//! A batch of collisions between moving circles and stationary lines.
+struct CircleLineBatch
+{
+    std::vector<float> centerX;     //!< The X position of each circle.
+    std::vector<float> centerY;     //!< The Y position of each circle.
+    std::vector<float> radius;      //!< The radius of each circle.
+    std::vector<float> startX;      //!< The X position of the start of each line.
+    std::vector<float> startY;      //!< The Y position of the start of each line.
+    std::vector<float> endX;        //!< The X position of the end of each line.
+    std::vector<float> endY;        //!< The Y position of the end of each line.
+    std::vector<float> velocityX;   //!< The X velocity of each circle.
+    std::vector<float> velocityY;   //!< The Y velocity of each circle.
+
+    std::vector<float> time;        //!< Output time of each collision, or <0 if no collision.
+    std::vector<float> normalX;     //!< Output X normal of each collision. Meaningless if no collision.
+    std::vector<float> normalY;     //!< Output Y normal of each collision. Meaningless if no collision.
+
+    //! Add a collision to the batch.
+    /*!
+    * See circleLine for the meaning of each parameter.
+    * \return The index of the collision in the batch.
+    */
+    size_t add(sf::Vector2f centerA, float radiusA, sf::Vector2f startB, sf::Vector2f endB, sf::Vector2f velocity);
+
+    //! Remove every collision from the batch.
+    void clear();
+
+    //! Get the number of collisions in the batch.
+    inline size_t size() const
+    {
+        return centerX.size();
+    }
+
+    //! Get the output normal of a collision.
+    /*!
+    * \param i The index of the collision.
+    * \return The normal.
+    */
+    inline sf::Vector2f getNormal(size_t i) const
+    {
+        return sf::Vector2f(normalX[i], normalY[i]);
+    }
+};
+
+//! Find the time and normal of every collision in a batch of circle-circle collisions.
+/*!
+* \param batch The batch. Its outputs are resized to match the inputs.
+*/
+void solveBatch(CircleCircleBatch& batch);
+
+//! Find the time and normal of every collision in a batch of circle-line collisions.
+/*!
+* Circles which might hit an endpoint of the line fall back to circleLine.
+* \param batch The batch. Its outputs are resized to match the inputs.
+*/
+void solveBatch(CircleLineBatch& batch);
+
+//! Get the number of collisions solved per instruction.
+/*!
+* \return 8 with AVX, 4 with SSE, or 1 if neither is available.
+*/
+size_t getBatchWidth();
+
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <stdexcept>
+#include "Broadphase.h"
+#include "Common.h"
+
+namespace ECSE
+{
+
+const size_t SortAndSweepBroadphase::maxInsertions;
+
+void SortAndSweepBroadphase::findPairs(const std::vector<AABB>& bounds, std::vector<Pair>& pairs)
+{
+    pairs.clear();
+
+    // Sort along the X axis, using the index as a tie-breaker so the output is deterministic
+    auto less = [&bounds](size_t a, size_t b)
+    {
+        if (bounds[a].min.x != bounds[b].min.x) return bounds[a].min.x < bounds[b].min.x;
+        return a < b;
+    };
+
+    // Start from the last order, dropping indices which no longer exist and adding new ones at the end
+    size_t previousSize = sortedIndices.size();
+    if (previousSize > bounds.size())
+    {
+        sortedIndices.erase(std::remove_if(sortedIndices.begin(), sortedIndices.end(),
+                                           [&bounds](size_t index) { return index >= bounds.size(); }),
+                            sortedIndices.end());
+    }
+
+    for (size_t i = previousSize; i < bounds.size(); ++i)
+    {
+        sortedIndices.push_back(i);
+    }
+
+    if (bounds.size() > previousSize + maxInsertions)
+    {
+        std::sort(sortedIndices.begin(), sortedIndices.end(), less);
+    }
+    else
+    {
+        // Most bounds are still in order, so each one only moves a short distance
+        for (size_t i = 1; i < sortedIndices.size(); ++i)
+        {
+            size_t index = sortedIndices[i];
+            size_t j = i;
+            for (; j > 0 && less(index, sortedIndices[j - 1]); --j)
+            {
+                sortedIndices[j] = sortedIndices[j - 1];
+            }
+            sortedIndices[j] = index;
+        }
+    }
+
+    sortedBounds.resize(bounds.size());
+    maxWidth = 0.f;
+    for (size_t i = 0; i < sortedIndices.size(); ++i)
+    {
+        sortedBounds[i] = bounds[sortedIndices[i]];
+        maxWidth = std::max(maxWidth, sortedBounds[i].max.x - sortedBounds[i].min.x);
+    }
+
+    // Sweep along the X axis, only checking bounds which start before the current one ends
+    for (size_t i = 0; i < sortedBounds.size(); ++i)
+    {
+        const AABB& a = sortedBounds[i];
+
+        for (size_t j = i + 1; j < sortedBounds.size() && sortedBounds[j].min.x <= a.max.x; ++j)
+        {
+            const AABB& b = sortedBounds[j];
+            if (a.min.y > b.max.y || b.min.y > a.max.y) continue;
+
+            size_t indexA = sortedIndices[i];
+            size_t indexB = sortedIndices[j];
+            pairs.push_back(Pair(std::min(indexA, indexB), std::max(indexA, indexB)));
+        }
+    }
+}
+
+void SortAndSweepBroadphase::query(const AABB& bounds, std::vector<size_t>& results) const
+{
+    results.clear();
+
+    // Nothing wider than maxWidth can start before this and still overlap
+    float start = bounds.min.x - maxWidth;
+    auto it = std::lower_bound(sortedBounds.begin(), sortedBounds.end(), start,
+                               [](const AABB& b, float x) { return b.min.x < x; });
+
+    for (; it != sortedBounds.end() && it->min.x <= bounds.max.x; ++it)
+    {
+        if (it->overlaps(bounds))
+        {
+            results.push_back(sortedIndices[it - sortedBounds.begin()]);
+        }
+    }
+}
+
+UniformGridBroadphase::UniformGridBroadphase(float cellSize, size_t maxCellsPerBounds)
+    : cellSize(cellSize), maxCellsPerBounds(maxCellsPerBounds)
+{
+    if (cellSize <= 0.f)
+    {
+        throw std::runtime_error("UniformGridBroadphase cell size must be positive");
+    }
+}
+
+void UniformGridBroadphase::findPairs(const std::vector<AABB>& bounds, std::vector<Pair>& pairs)
+{
+    pairs.clear();
+    lastBounds = bounds;
+    oversized.clear();
+
+    // Forget indices which no longer exist
+    for (size_t i = bounds.size(); i < ranges.size(); ++i)
+    {
+        if (!isOversized[i]) removeFromCells(i, ranges[i]);
+    }
+
+    size_t previousSize = std::min(ranges.size(), bounds.size());
+    ranges.resize(bounds.size());
+    isOversized.resize(bounds.size());
+
+    // Only move bounds between cells if they cover different cells to last time
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        CellRange range = getCellRange(bounds[i]);
+        bool rangeOversized = isRangeOversized(range);
+
+        if (i < previousSize)
+        {
+            if (range == ranges[i] && rangeOversized == isOversized[i])
+            {
+                if (rangeOversized) oversized.push_back(i);
+                continue;
+            }
+
+            if (!isOversized[i]) removeFromCells(i, ranges[i]);
+        }
+
+        ranges[i] = range;
+        isOversized[i] = rangeOversized;
+
+        if (rangeOversized)
+        {
+            oversized.push_back(i);
+        }
+        else
+        {
+            addToCells(i, range);
+        }
+    }
+
+    // Empty cells are kept so their storage can be reused, but they shouldn't pile up forever
+    if (cells.size() > pruneSize)
+    {
+        for (auto it = cells.begin(); it != cells.end();)
+        {
+            if (it->second.empty()) it = cells.erase(it);
+            else ++it;
+        }
+
+        pruneSize = std::max(pruneSize, cells.size() * 2);
+    }
+
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        if (isOversized[i]) continue;
+
+        const CellRange& rangeA = ranges[i];
+
+        for (int x = rangeA.minX; x <= rangeA.maxX; ++x)
+        {
+            for (int y = rangeA.minY; y <= rangeA.maxY; ++y)
+            {
+                for (size_t j : cells[getCellKey(x, y)])
+                {
+                    if (j <= i) continue;
+
+                    // A pair may share several cells, so only report it from the first cell they share
+                    const CellRange& rangeB = ranges[j];
+                    if (x != std::max(rangeA.minX, rangeB.minX) || y != std::max(rangeA.minY, rangeB.minY)) continue;
+
+                    if (bounds[i].overlaps(bounds[j]))
+                    {
+                        pairs.push_back(Pair(i, j));
+                    }
+                }
+            }
+        }
+    }
+
+    // Oversized bounds are checked against everything
+    for (size_t i : oversized)
+    {
+        for (size_t j = 0; j < bounds.size(); ++j)
+        {
+            if (j == i || (isOversized[j] && j < i)) continue;
+
+            if (bounds[i].overlaps(bounds[j]))
+            {
+                pairs.push_back(Pair(std::min(i, j), std::max(i, j)));
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::query(const AABB& bounds, std::vector<size_t>& results) const
+{
+    results.clear();
+
+    CellRange range = getCellRange(bounds);
+
+    // Checking every cell would be slower than just checking every bounds
+    if (isRangeOversized(range))
+    {
+        for (size_t i = 0; i < lastBounds.size(); ++i)
+        {
+            if (lastBounds[i].overlaps(bounds)) results.push_back(i);
+        }
+
+        return;
+    }
+
+    if (queryStamps.size() < lastBounds.size())
+    {
+        queryStamps.resize(lastBounds.size(), 0);
+    }
+    ++queryStamp;
+
+    for (int x = range.minX; x <= range.maxX; ++x)
+    {
+        for (int y = range.minY; y <= range.maxY; ++y)
+        {
+            auto it = cells.find(getCellKey(x, y));
+            if (it == cells.end()) continue;
+
+            for (size_t i : it->second)
+            {
+                if (queryStamps[i] == queryStamp) continue;
+                queryStamps[i] = queryStamp;
+
+                if (lastBounds[i].overlaps(bounds)) results.push_back(i);
+            }
+        }
+    }
+
+    for (size_t i : oversized)
+    {
+        if (lastBounds[i].overlaps(bounds)) results.push_back(i);
+    }
+}
+
+bool UniformGridBroadphase::isRangeOversized(const CellRange& range) const
+{
+    std::int64_t cellCount = std::int64_t(range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+    return cellCount > static_cast<std::int64_t>(maxCellsPerBounds);
+}
+
+void UniformGridBroadphase::addToCells(size_t index, const CellRange& range)
+{
+    for (int x = range.minX; x <= range.maxX; ++x)
+    {
+        for (int y = range.minY; y <= range.maxY; ++y)
+        {
+            cells[getCellKey(x, y)].push_back(index);
+        }
+    }
+}
+
+void UniformGridBroadphase::removeFromCells(size_t index, const CellRange& range)
+{
+    for (int x = range.minX; x <= range.maxX; ++x)
+    {
+        for (int y = range.minY; y <= range.maxY; ++y)
+        {
+            auto& cell = cells[getCellKey(x, y)];
+
+            auto it = std::find(cell.begin(), cell.end(), index);
+            if (it != cell.end())
+            {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+UniformGridBroadphase::CellRange UniformGridBroadphase::getCellRange(const AABB& bounds) const
+{
+    // Clamp so that far-flung bounds don't overflow the cell coordinates
+    static const float limit = 1e9f;
+
+    auto toCell = [this](float value)
+    {
+        return static_cast<int>(std::floor(ECSE::clamp(-limit, limit, value / cellSize)));
+    };
+
+    CellRange range;
+    range.minX = toCell(bounds.min.x);
+    range.minY = toCell(bounds.min.y);
+    range.maxX = toCell(bounds.max.x);
+    range.maxY = toCell(bounds.max.y);
+
+    return range;
+}
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include "CollisionMath.h"
+
+namespace ECSE
+{
+
+//! Finds pairs of colliders whose bounds overlap so that only those pairs need exact collision tests.
+/*!
+* Colliders are identified by their index in the bounds vector passed to findPairs. Implementations may
+* assume that an index refers to the same collider as in the last call, since colliders rarely move far
+* between calls, but must still give correct results if it doesn't.
+*/
+class Broadphase
+{
+public:
+    //! A pair of indices into the bounds vector. The first index is always lower than the second.
+    typedef std::pair<size_t, size_t> Pair;
+
+    //! Destroy the Broadphase.
+    virtual ~Broadphase() {}
+
+    //! Find every pair of overlapping bounds.
+    /*!
+    * The bounds are remembered until the next call so that they can be used by query.
+    *
+    * \param bounds The bounds of each collider.
+    * \param pairs Filled with each pair of overlapping bounds. Existing contents are cleared.
+    */
+    virtual void findPairs(const std::vector<AABB>& bounds, std::vector<Pair>& pairs) = 0;
+
+    //! Find the indices of bounds from the last call to findPairs which overlap some other bounds.
+    /*!
+    * \param bounds The bounds to check.
+    * \param results Filled with the overlapping indices. Existing contents are cleared.
+    */
+    virtual void query(const AABB& bounds, std::vector<size_t>& results) const = 0;
+};
+
+//! A Broadphase which sorts bounds along the X axis and sweeps over them to find overlaps.
+/*!
+* Works well when colliders are spread out along the X axis, and has no tuning parameters. The order from
+* the last call is kept and fixed up with an insertion sort, which is close to linear when colliders move
+* a little at a time.
+*/
+class SortAndSweepBroadphase : public Broadphase
+{
+public:
+    //! Find every pair of overlapping bounds.
+    /*!
+    * \param bounds The bounds of each collider.
+    * \param pairs Filled with each pair of overlapping bounds.
+    */
+    void findPairs(const std::vector<AABB>& bounds, std::vector<Pair>& pairs) override;
+
+    //! Find the indices of bounds from the last call to findPairs which overlap some other bounds.
+    /*!
+    * \param bounds The bounds to check.
+    * \param results Filled with the overlapping indices.
+    */
+    void query(const AABB& bounds, std::vector<size_t>& results) const override;
+
+    //! If more bounds than this are added at once, they're sorted from scratch instead of with an insertion sort.
+    static const size_t maxInsertions = 16;
+
+private:
+    std::vector<AABB> sortedBounds;     //!< The bounds from the last call to findPairs, sorted by min.x.
+    std::vector<size_t> sortedIndices;  //!< The original index of each element in sortedBounds.
+    float maxWidth = 0.f;               //!< The largest width in sortedBounds.
+};
+
+//! A Broadphase which buckets bounds into a uniform grid of square cells.
+/*!
+* Works well when colliders are of a similar size, ideally somewhat smaller than a cell. The grid is kept
+* between calls, and bounds are only moved between cells when they cover a different range of cells.
+*/
+class UniformGridBroadphase : public Broadphase
+{
+public:
+    //! Construct the UniformGridBroadphase.
+    /*!
+    * \param cellSize The width and height of each cell.
+    * \param maxCellsPerBounds Bounds covering more cells than this are checked against everything instead
+    *                          of being added to the grid.
+    */
+    explicit UniformGridBroadphase(float cellSize = 64.f, size_t maxCellsPerBounds = 64);
+
+    //! Find every pair of overlapping bounds.
+    /*!
+    * \param bounds The bounds of each collider.
+    * \param pairs Filled with each pair of overlapping bounds.
+    */
+    void findPairs(const std::vector<AABB>& bounds, std::vector<Pair>& pairs) override;
+
+    //! Find the indices of bounds from the last call to findPairs which overlap some other bounds.
+    /*!
+    * \param bounds The bounds to check.
+    * \param results Filled with the overlapping indices.
+    */
+    void query(const AABB& bounds, std::vector<size_t>& results) const override;
+
+    //! Get the width and height of each cell.
+    inline float getCellSize() const
+    {
+        return cellSize;
+    }
+
+private:
+    //! A range of cells covered by some bounds.
+    struct CellRange
+    {
+        int minX, minY, maxX, maxY;
+
+        //! Check whether two ranges cover the same cells.
+        inline bool operator==(const CellRange& other) const
+        {
+            return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+        }
+    };
+
+    //! Get the range of cells covered by some bounds.
+    CellRange getCellRange(const AABB& bounds) const;
+
+    //! Check whether a range covers too many cells to be added to the grid.
+    bool isRangeOversized(const CellRange& range) const;
+
+    //! Add an index to every cell in a range.
+    void addToCells(size_t index, const CellRange& range);
+
+    //! Remove an index from every cell in a range.
+    void removeFromCells(size_t index, const CellRange& range);
+
+    //! Get the key of a cell in the cell map.
+    static inline std::int64_t getCellKey(int x, int y)
+    {
+        return (static_cast<std::int64_t>(x) << 32) ^ static_cast<std::uint32_t>(y);
+    }
+
+    float cellSize;                                             //!< The width and height of each cell.
+    size_t maxCellsPerBounds;                                   //!< Bounds covering more cells than this are oversized.
+    std::unordered_map<std::int64_t, std::vector<size_t>> cells; //!< Map from cell key to the indices in that cell.
+    std::vector<size_t> oversized;                              //!< Indices of bounds which were too large for the grid.
+    std::vector<AABB> lastBounds;                               //!< The bounds from the last call to findPairs.
+    std::vector<CellRange> ranges;                              //!< The range of cells covered by each of lastBounds.
+    std::vector<bool> isOversized;                              //!< Whether each of lastBounds was too large for the grid.
+    size_t pruneSize = 1024;                                    //!< Empty cells are removed when there are more cells than this.
+    mutable std::vector<size_t> queryStamps;                    //!< Marks indices already returned by the current query.
+    mutable size_t queryStamp = 0;                              //!< The stamp of the current query.
+};
+
+}
@@ -5,6 +5,7 @@
 #include "Component.h"
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 namespace ECSE
 {
@@ -12,12 +13,17 @@ namespace ECSE
 //! Represents a collision between two Entities.
 struct Collision
 {
+    //! The part index of a collider which isn't a CompoundColliderComponent.
+    static const size_t noPart = static_cast<size_t>(-1);
+
     Entity* self;                   //!< The Entity that collided.
     Entity* other;                  //!< The Entity that self collided with.
     float time;                     //!< The inter-frame time at which the collision occurred (between 0 and 1).
     sf::Vector2f position;          //!< The position of this Entity when the collision occurred.
     sf::Vector2f otherPosition;     //!< The position of the other Entity when the collision occurred.
     sf::Vector2f normal;            //!< The normal of the collision (direction is from self to other).
+    size_t part = noPart;           //!< The part of self's CompoundColliderComponent which collided, or noPart.
+    size_t otherPart = noPart;      //!< The part of other's CompoundColliderComponent which collided, or noPart.
 
     //! Construct a Collision.
     Collision(Entity* self, Entity* other, float time, sf::Vector2f position, sf::Vector2f otherPosition, sf::Vector2f normal)
@@ -30,10 +36,33 @@ struct Collision
     {
         std::swap(self, other);
         std::swap(position, otherPosition);
+        std::swap(part, otherPart);
         normal = -normal;
     }
 };
 
+//! Reports a sensor overlapping another collider.
+struct SensorEvent
+{
+    //! The kinds of sensor event.
+    enum Type
+    {
+        ENTER,  //!< The colliders started overlapping in this step.
+        STAY,   //!< The colliders were already overlapping and still are.
+        EXIT    //!< The colliders stopped overlapping in this step.
+    };
+
+    Type type;                      //!< The kind of event.
+    Entity* sensor;                 //!< The Entity with the sensor collider.
+    Entity* other;                  //!< The Entity which the sensor overlapped.
+
+    //! Construct a SensorEvent.
+    SensorEvent(Type type, Entity* sensor, Entity* other)
+        : type(type), sensor(sensor), other(other)
+    {
+    }
+};
+
 //! A Component which stores collider and collision data.
 class ColliderComponent : public Component
 {
@@ -41,6 +70,42 @@ public:
     //! The collider's offset from the object's center.
     sf::Vector2f offset;
 
+    //! Whether the collider never moves.
+    /*!
+    * Static colliders are baked into a bounding volume hierarchy when they're added to the
+    * CollisionSystem, so they must not move (or have this flag changed) while registered.
+    * Static colliders are never checked against each other.
+    */
+    bool isStatic = false;
+
+    //! Whether the collider only reports overlaps instead of colliding.
+    /*!
+    * Sensors never go through collision detection or call their callbacks. Instead, the CollisionSystem
+    * checks what they overlap at the end of each step and reports it with SensorEvents. Like isStatic,
+    * this must not be changed while the Entity is registered. Sensors don't detect each other.
+    */
+    bool isSensor = false;
+
+    //! Built-in ways of reacting to a collision.
+    enum Response
+    {
+        NONE,       //!< Leave it to the callbacks.
+        REFLECT,    //!< Bounce off the other collider, keeping restitution of the speed into it.
+        SLIDE,      //!< Stop moving into the other collider, but keep moving along its surface.
+        STOP        //!< Stop where the collision happened.
+    };
+
+    //! How the CollisionSystem moves this collider's Entity when it collides.
+    /*!
+    * Responses are applied by the CollisionSystem itself before any callbacks are called, so callbacks can
+    * still override them. The Entity's current position is set to where it collided, and only the rest of
+    * its motion in the step is changed. Entities with parents or moving discretely aren't moved.
+    */
+    Response response = NONE;
+
+    //! The fraction of speed into the other collider which is kept when reflecting.
+    float restitution = 1.f;
+
     //! A set of Entities that were changed by a collision.
     typedef std::set<Entity*> ChangeSet;
 
@@ -69,6 +134,95 @@ public:
         callbacks.push_back(fn);
     }
 
+    //! A list of Entities that were changed by a collision, which may contain duplicates.
+    typedef std::vector<Entity*> ChangeList;
+
+    //! Contact callback type.
+    /*!
+    * This works like CallbackType, except that changed Entities are appended to a list which the
+    * CollisionSystem reuses, rather than returned in a new ChangeSet.
+    */
+    typedef std::function<void(const Collision&, ChangeList&)> ContactCallbackType;
+
+    //! Adds a contact callback function which will be called when a collision occurs.
+    /*!
+    * Contact callbacks are called after any callbacks added with addCallback.
+    * \param fn The function to call. See ContactCallbackType for more information.
+    */
+    inline void addContactCallback(ContactCallbackType fn)
+    {
+        contactCallbacks.push_back(fn);
+    }
+
+    //! Get the collision layers this collider is on.
+    /*!
+    * \return A bitfield with a bit set for each layer.
+    */
+    inline std::uint32_t getLayer() const
+    {
+        return layer;
+    }
+
+    //! Set the collision layers this collider is on.
+    /*!
+    * If this is changed during a collision callback, the Entity should be in the returned ChangeSet.
+    * \param newLayer A bitfield with a bit set for each layer.
+    */
+    inline void setLayer(std::uint32_t newLayer)
+    {
+        layer = newLayer;
+        ++filterVersion;
+    }
+
+    //! Get the layers this collider can collide with.
+    /*!
+    * \return A bitfield with a bit set for each layer.
+    */
+    inline std::uint32_t getMask() const
+    {
+        return mask;
+    }
+
+    //! Set the layers this collider can collide with.
+    /*!
+    * If this is changed during a collision callback, the Entity should be in the returned ChangeSet.
+    * \param newMask A bitfield with a bit set for each layer.
+    */
+    inline void setMask(std::uint32_t newMask)
+    {
+        mask = newMask;
+        ++filterVersion;
+    }
+
+    //! Check whether the layers and masks of two colliders allow them to collide.
+    /*!
+    * Each collider has to be on a layer in the other's mask.
+    * \param other The other collider.
+    * \return Whether the two may collide.
+    */
+    inline bool canCollideWith(const ColliderComponent& other) const
+    {
+        return (layer & other.mask) != 0 && (other.layer & mask) != 0;
+    }
+
+    //! Get a number which changes whenever the layer or mask is changed.
+    /*!
+    * \return The filter version.
+    */
+    inline unsigned getFilterVersion() const
+    {
+        return filterVersion;
+    }
+
+    //! Check whether any callback functions have been added.
+    /*!
+    * \return Whether there are any callbacks.
+    */
+    inline bool hasCallbacks() const
+    {
+        return !callbacks.empty() || !contactCallbacks.empty();
+    }
+
     //! Call the callback functions.
     /*!
     * \param collision The collision to handle.
@@ -76,19 +230,37 @@ public:
     */
     inline ChangeSet callCallbacks(const Collision& collision)
     {
-        ChangeSet changes;
+        ChangeList changes;
+        callCallbacks(collision, changes);
 
+        return ChangeSet(changes.begin(), changes.end());
+    };
+
+    //! Call the callback functions, appending any changed Entities to a list.
+    /*!
+    * \param collision The collision to handle.
+    * \param changes The list to append changed Entities to.
+    */
+    inline void callCallbacks(const Collision& collision, ChangeList& changes)
+    {
         for (auto& fn : callbacks)
         {
             auto newChanges = fn(collision);
-            changes.insert(newChanges.begin(), newChanges.end());
+            changes.insert(changes.end(), newChanges.begin(), newChanges.end());
         }
 
-        return changes;
-    };
+        for (auto& fn : contactCallbacks)
+        {
+            fn(collision, changes);
+        }
+    }
 
 private:
     std::vector<CallbackType> callbacks;    //! Callback functions for when collisions occur.
+    std::vector<ContactCallbackType> contactCallbacks;  //!< Contact callback functions for when collisions occur.
+    std::uint32_t layer = 1;                //!< The collision layers this collider is on.
+    std::uint32_t mask = ~0u;               //!< The layers this collider can collide with.
+    unsigned filterVersion = 0;             //!< Incremented when layer or mask changes.
 };
 
 }
@@ -1,8 +1,10 @@
+#include <sstream>
 #include "World.h"
 #include "VectorMath.h"
 #include "CollisionDebugSystem.h"
 #include "CircleColliderComponent.h"
 #include "LineColliderComponent.h"
+#include "CompoundColliderComponent.h"
 
 namespace ECSE
 {
@@ -14,6 +16,7 @@ static const sf::Color sweepColor = sf::Color(255, 255, 0);
 static const sf::Color discreteJumpColor = sf::Color(255, 0, 255);
 static const sf::Color collisionColor = sf::Color(0, 255, 255);
 static const sf::Color endColor = sf::Color(255, 0, 0);
+static const unsigned statisticsSize = 12;
 
 //! Resize and center a circle.
 /*!
@@ -29,6 +32,8 @@ static void resizeCircle(sf::CircleShape& circle, float radius)
 CollisionDebugSystem::CollisionDebugSystem(World* world)
     : SetSystem(world), renderTarget(*world->getEngine()->getRenderTarget())
 {
+    require<TransformComponent, ColliderComponent>();
+
     circleShape.setOutlineThickness(thickness);
     circleShape.setFillColor(clearColor);
 }
@@ -48,6 +53,7 @@ void CollisionDebugSystem::render(float alpha, sf::RenderTarget& renderTarget)
     {
         drawCircleSweep(*e);
         drawLineSweep(*e);
+        drawCompoundSweep(*e);
     }
 
     if (drawCollisions)
@@ -58,15 +64,19 @@ void CollisionDebugSystem::render(float alpha, sf::RenderTarget& renderTarget)
             drawCollision(collision);
         }
     }
+
+    if (statisticsFont)
+    {
+        drawStatistics();
+    }
 }
 
 bool CollisionDebugSystem::checkRequirements(const Entity& e) const
 {
-    if (!e.getComponent<TransformComponent>()) return false;
-
-    // Need one of these
+    // The signature covers the transform and collider, but the collider needs to be one of these
     if (e.getComponent<CircleColliderComponent>()) return true;
     if (e.getComponent<LineColliderComponent>()) return true;
+    if (e.getComponent<CompoundColliderComponent>()) return true;
 
     return false;
 }
@@ -94,9 +104,11 @@ void CollisionDebugSystem::internalAddEntity(Entity& e)
     auto listener = std::bind(&CollisionDebugSystem::collisionCallback, this, std::placeholders::_1);
     auto circle = e.getComponent<CircleColliderComponent>();
     auto line = e.getComponent<LineColliderComponent>();
+    auto compound = e.getComponent<CompoundColliderComponent>();
 
     if (circle) circle->addCallback(listener);
     if (line) line->addCallback(listener);
+    if (compound) compound->addCallback(listener);
 }
 
 void CollisionDebugSystem::drawCircleSweep(const Entity& e)
@@ -104,27 +116,61 @@ void CollisionDebugSystem::drawCircleSweep(const Entity& e)
     auto collider = e.getComponent<CircleColliderComponent>();
     if (collider == nullptr) return;
 
-    float radius = collider->radius;
+    auto transform = e.getComponent<TransformComponent>();
+    drawCircleMotion(collisionSystem->getColliderPosition(e), collisionSystem->getNextColliderPosition(e),
+                     collider->radius, transform->isPositionDiscrete());
+}
+
+void CollisionDebugSystem::drawLineSweep(const Entity& e)
+{
+    auto collider = e.getComponent<LineColliderComponent>();
+    if (collider == nullptr) return;
+
+    auto transform = e.getComponent<TransformComponent>();
+    drawLineMotion(collisionSystem->getColliderPosition(e), collisionSystem->getNextColliderPosition(e),
+                   collider->vec, transform->isPositionDiscrete());
+}
+
+void CollisionDebugSystem::drawCompoundSweep(const Entity& e)
+{
+    auto collider = e.getComponent<CompoundColliderComponent>();
+    if (collider == nullptr) return;
+
     auto transform = e.getComponent<TransformComponent>();
     sf::Vector2f start = collisionSystem->getColliderPosition(e);
+    sf::Vector2f end = collisionSystem->getNextColliderPosition(e);
 
+    // Parts move with the collider, but don't rotate with it
+    for (auto& part : collider->parts)
+    {
+        if (part.type == CompoundColliderComponent::Part::CIRCLE)
+        {
+            drawCircleMotion(start + part.offset, end + part.offset, part.radius, transform->isPositionDiscrete());
+        }
+        else
+        {
+            drawLineMotion(start + part.offset, end + part.offset, part.vec, transform->isPositionDiscrete());
+        }
+    }
+}
+
+void CollisionDebugSystem::drawCircleMotion(sf::Vector2f start, sf::Vector2f end, float radius, bool discrete)
+{
     // Draw initial position
-    resizeCircle(circleShape, collider->radius);
+    resizeCircle(circleShape, radius);
     circleShape.setOutlineColor(startColor);
     circleShape.setPosition(start);
     renderTarget.draw(circleShape);
 
     if (drawTrails)
     {
-        sf::Vector2f end = collisionSystem->getNextColliderPosition(e);
-
         auto forward = start - end;
         forward = normalize(forward);
 
         auto up = rotate90(forward) * radius;
 
         // Draw discrete jump line
-        if (transform->isPositionDiscrete())
+        if (discrete)
         {
             sf::Vertex line[] = {
                 sf::Vertex(start, discreteJumpColor),
@@ -146,28 +192,21 @@ void CollisionDebugSystem::drawCircleSweep(const Entity& e)
     }
 }
 
-void CollisionDebugSystem::drawLineSweep(const Entity& e)
+void CollisionDebugSystem::drawLineMotion(sf::Vector2f start, sf::Vector2f end, sf::Vector2f vec, bool discrete)
 {
-    auto collider = e.getComponent<LineColliderComponent>();
-    if (collider == nullptr) return;
-
-    auto transform = e.getComponent<TransformComponent>();
-    sf::Vector2f start = collisionSystem->getColliderPosition(e);
-
     sf::Vector2f aa = start;
-    sf::Vector2f ba = start + collider->vec;
+    sf::Vector2f ba = start + vec;
 
     // Draw initial position
     drawLine(aa, ba, startColor);
 
     if (drawTrails)
     {
-        sf::Vector2f end = collisionSystem->getNextColliderPosition(e);
         sf::Vector2f ab = end;
-        sf::Vector2f bb = end + collider->vec;
+        sf::Vector2f bb = end + vec;
 
         // Draw discrete jump line
-        if (transform->isPositionDiscrete())
+        if (discrete)
         {
             drawLine(midpoint(aa, ba),
                      midpoint(ab, bb),
@@ -213,6 +252,50 @@ void CollisionDebugSystem::drawCollision(const Collision& collision)
     {
         drawLine(colliderPos, colliderPos + line->vec, collisionColor);
     }
+
+    // Only the part which was hit is drawn
+    auto compound = entity->getComponent<CompoundColliderComponent>();
+    if (compound && collision.part < compound->parts.size())
+    {
+        auto& part = compound->parts[collision.part];
+        if (part.type == CompoundColliderComponent::Part::CIRCLE)
+        {
+            resizeCircle(circleShape, part.radius);
+            circleShape.setOutlineColor(collisionColor);
+            circleShape.setPosition(colliderPos + part.offset);
+            renderTarget.draw(circleShape);
+        }
+        else
+        {
+            drawLine(colliderPos + part.offset, colliderPos + part.offset + part.vec, collisionColor);
+        }
+    }
+}
+
+void CollisionDebugSystem::drawStatistics()
+{
+    auto& statistics = collisionSystem->getStatistics();
+
+    // One line per phase is easier to read than the logged form
+    std::ostringstream stream;
+    stream << statistics.colliders << " colliders, " << statistics.islands << " islands\n"
+           << statistics.pairs << " pairs, " << statistics.narrowphaseTests << " tests, "
+           << statistics.hits << " hits, " << statistics.rounds << " rounds\n"
+           << statistics.cacheRebuilds << " cache rebuilds, " << statistics.staticTreeRebuilds << " static rebuilds\n"
+           << "refresh " << statistics.refreshTime.asMicroseconds() << "us\n"
+           << "broadphase " << statistics.broadphaseTime.asMicroseconds() << "us\n"
+           << "islands " << statistics.islandTime.asMicroseconds() << "us\n"
+           << "solve " << statistics.solveTime.asMicroseconds() << "us "
+           << "(narrowphase " << statistics.narrowphaseTime.asMicroseconds() << "us)\n"
+           << "sensors " << statistics.sensorTime.asMicroseconds() << "us\n"
+           << "total " << statistics.totalTime.asMicroseconds() << "us";
+
+    statisticsText.setFont(*statisticsFont);
+    statisticsText.setCharacterSize(statisticsSize);
+    statisticsText.setString(stream.str());
+    statisticsText.setPosition(renderTarget.mapPixelToCoords(sf::Vector2i(0, 0)));
+
+    renderTarget.draw(statisticsText);
 }
 
 void CollisionDebugSystem::drawLine(const sf::Vector2f& start, const sf::Vector2f& end,
@@ -227,6 +310,9 @@ void CollisionDebugSystem::drawLine(const sf::Vector2f& start, const sf::Vector2
 
 ColliderComponent::ChangeSet CollisionDebugSystem::collisionCallback(const Collision& collision)
 {
+    // Collision islands may be solved on several threads at once
+    std::lock_guard<std::mutex> lock(bufferMutex);
+
     collisionBuffer.push_back(collision);
 
     if (verbose)
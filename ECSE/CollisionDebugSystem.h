@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include "SetSystem.h"
 #include "TransformSystem.h"
 #include "Engine.h"
@@ -67,6 +68,12 @@ public:
     //! Whether to draw collisions.
     bool drawCollisions = true;
 
+    //! The font to draw the CollisionSystem's statistics with, or null to not draw them.
+    /*!
+    * The statistics are drawn in the top-left corner of the RenderTarget.
+    */
+    const sf::Font* statisticsFont = nullptr;
+
 protected:
     //! Add an Entity to the internal Entity set.
     /*!
@@ -90,6 +97,30 @@ private:
     */
     void drawLineSweep(const Entity& e);
 
+    //! Draw the sweep of each part of an entity's compound collider (if it has one).
+    /*!
+    * \param e The Entity.
+    */
+    void drawCompoundSweep(const Entity& e);
+
+    //! Draw a circle at its start and end positions, and the area it sweeps between them.
+    /*!
+    * \param start The circle's start position.
+    * \param end The circle's end position.
+    * \param radius The circle's radius.
+    * \param discrete Whether the circle jumps to the end rather than sweeping.
+    */
+    void drawCircleMotion(sf::Vector2f start, sf::Vector2f end, float radius, bool discrete);
+
+    //! Draw a line at its start and end positions, and the area it sweeps between them.
+    /*!
+    * \param start The position of the line's start at the start of the step.
+    * \param end The position of the line's start at the end of the step.
+    * \param vec The vector from the start to the end of the line.
+    * \param discrete Whether the line jumps to the end rather than sweeping.
+    */
+    void drawLineMotion(sf::Vector2f start, sf::Vector2f end, sf::Vector2f vec, bool discrete);
+
     //! Draw a collision.
     /*!
     * \param The collision to draw.
@@ -104,6 +135,9 @@ private:
     */
     void drawLine(const sf::Vector2f& start, const sf::Vector2f& end, const sf::Color& color);
 
+    //! Draw the CollisionSystem's statistics from the last advance step.
+    void drawStatistics();
+
     //! Callback function for collisions.
     /*!
     * Adds the collision to the buffer.
@@ -122,11 +156,17 @@ private:
     //! The circle shape reused in drawing.
     sf::CircleShape circleShape;
 
+    //! The text reused in drawing statistics.
+    sf::Text statisticsText;
+
     //! The CollisionSystem of this System's World.
     CollisionSystem* collisionSystem;
 
     //! Buffer of collisions that occurred this frame
     std::vector<Collision> collisionBuffer;
+
+    //! Guards collisionBuffer, since callbacks may be called from several threads.
+    std::mutex bufferMutex;
 };
 
 }
@@ -5,13 +5,7 @@
 namespace ECSE
 {
 
-//! Ignore time 0 collisions with an overlap less than this.
-/*!
-* This avoids collisions happening multiple times because of floating-point error.
-*/
 const float collisionFudge = 0.5f;
-
-//! Square of collisionFudge.
 const float collisionFudgeSqr = collisionFudge * collisionFudge;
 
 LineIntersection findLineIntersection(sf::Vector2f startA, sf::Vector2f endA,
@@ -55,6 +49,91 @@ float projectPointOntoLine(sf::Vector2f& point, sf::Vector2f start, sf::Vector2f
     return t;
 }
 
+sf::Vector2f findClosestPointOnLine(sf::Vector2f point, sf::Vector2f start, sf::Vector2f end)
+{
+    // A zero-length line would divide by zero
+    if (start == end) return start;
+
+    float t = projectPointOntoLine(point, start, end);
+
+    if (t <= 0.f) return start;
+    if (t >= 1.f) return end;
+    return point;
+}
+
+float raycastAABB(sf::Vector2f start, sf::Vector2f end, const AABB& bounds)
+{
+    // Clip the segment against the slab between each pair of sides
+    sf::Vector2f delta = end - start;
+    float enter = 0.f;
+    float exit = 1.f;
+
+    auto clip = [&enter, &exit](float from, float change, float min, float max)
+    {
+        if (change == 0.f) return from >= min && from <= max;
+
+        float t1 = (min - from) / change;
+        float t2 = (max - from) / change;
+        if (t1 > t2) std::swap(t1, t2);
+
+        enter = std::max(enter, t1);
+        exit = std::min(exit, t2);
+        return enter <= exit;
+    };
+
+    if (!clip(start.x, delta.x, bounds.min.x, bounds.max.x)) return -1.f;
+    if (!clip(start.y, delta.y, bounds.min.y, bounds.max.y)) return -1.f;
+
+    return enter;
+}
+
+float raycastCircle(sf::Vector2f start, sf::Vector2f end, sf::Vector2f center, float radius, sf::Vector2f& normal)
+{
+    sf::Vector2f toStart = start - center;
+    float radiusSqr = radius * radius;
+    float startDistSqr = getSqrMagnitude(toStart);
+
+    // Already inside
+    if (startDistSqr <= radiusSqr)
+    {
+        normal = toStart;
+        if (startDistSqr > 0.f) ECSE::normalize(normal);
+        return 0.f;
+    }
+
+    // Solve |toStart + delta * t| = radius for the smallest t
+    sf::Vector2f delta = end - start;
+    float a = getSqrMagnitude(delta);
+    if (a == 0.f) return -1.f;
+
+    float b = getDotProduct(toStart, delta);
+    float discriminant = b * b - a * (startDistSqr - radiusSqr);
+    if (discriminant < 0.f) return -1.f;
+
+    float t = (-b - sqrt(discriminant)) / a;
+    if (t < 0.f || t > 1.f) return -1.f;
+
+    normal = toStart + delta * t;
+    ECSE::normalize(normal);
+
+    return t;
+}
+
+float raycastLine(sf::Vector2f start, sf::Vector2f end, sf::Vector2f lineStart, sf::Vector2f lineEnd, sf::Vector2f& normal)
+{
+    auto intersectResult = findLineIntersection(start, end, lineStart, lineEnd);
+    if (!intersectResult.strictIntersection) return -1.f;
+
+    normal = lineEnd - lineStart;
+    ECSE::rotate90(normal);
+    ECSE::normalize(normal);
+
+    // Face whichever side the segment came from
+    if (getDotProduct(normal, start - lineStart) < 0.f) normal = -normal;
+
+    return intersectResult.t;
+}
+
 // http://www.gamasutra.com/view/feature/131424/pool_hall_lessons_fast_accurate_.php
 void circleCircle(sf::Vector2f centerA, float radiusA, sf::Vector2f centerB, float radiusB,
                   sf::Vector2f velocity, float &time, sf::Vector2f &normal)
@@ -1,12 +1,90 @@
 //! \file CollisionMath.h Contains functions for solving collision times.
 
 #include "SFML/System.hpp"
+#include <algorithm>
+#include <limits>
 
 #pragma once
 
 namespace ECSE
 {
 
+//! Ignore time 0 collisions with an overlap less than this.
+/*!
+* This avoids collisions happening multiple times because of floating-point error.
+*/
+extern const float collisionFudge;
+
+//! Square of collisionFudge.
+extern const float collisionFudgeSqr;
+
+//! An axis-aligned bounding box.
+struct AABB
+{
+    sf::Vector2f min;   //!< The corner with the smallest coordinates.
+    sf::Vector2f max;   //!< The corner with the largest coordinates.
+
+    //! Construct an empty AABB, which takes the bounds of the first point it includes.
+    AABB()
+        : min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
+          max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max())
+    {
+    }
+
+    //! Construct an AABB from its corners.
+    AABB(sf::Vector2f min, sf::Vector2f max)
+        : min(min), max(max)
+    {
+    }
+
+    //! Grow the AABB to include a point.
+    /*!
+    * \param point The point to include.
+    */
+    inline void include(const sf::Vector2f& point)
+    {
+        min.x = std::min(min.x, point.x);
+        min.y = std::min(min.y, point.y);
+        max.x = std::max(max.x, point.x);
+        max.y = std::max(max.y, point.y);
+    }
+
+    //! Grow the AABB by the same amount in every direction.
+    /*!
+    * \param amount The distance to grow each side by.
+    */
+    inline void pad(float amount)
+    {
+        min.x -= amount;
+        min.y -= amount;
+        max.x += amount;
+        max.y += amount;
+    }
+
+    //! Check whether this overlaps another AABB.
+    /*!
+    * Touching edges count as an overlap.
+    * \param other The other AABB.
+    * \return Whether the two overlap.
+    */
+    inline bool overlaps(const AABB& other) const
+    {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+               min.y <= other.max.y && other.min.y <= max.y;
+    }
+
+    //! Check whether another AABB lies entirely within this one.
+    /*!
+    * \param other The other AABB.
+    * \return Whether other is inside this.
+    */
+    inline bool contains(const AABB& other) const
+    {
+        return min.x <= other.min.x && other.max.x <= max.x &&
+               min.y <= other.min.y && other.max.y <= max.y;
+    }
+};
+
 //! Represents an intersection between two lines.
 struct LineIntersection
 {
@@ -36,6 +114,46 @@ LineIntersection findLineIntersection(sf::Vector2f startA, sf::Vector2f endA,
 */
 float projectPointOntoLine(sf::Vector2f& point, sf::Vector2f start, sf::Vector2f end);
 
+//! Find the closest point on a line segment to another point.
+/*!
+* \param point The point.
+* \param start The start of the line segment.
+* \param end The end of the line segment.
+* \return The point on the segment which is closest to point.
+*/
+sf::Vector2f findClosestPointOnLine(sf::Vector2f point, sf::Vector2f start, sf::Vector2f end);
+
+//! Find where a line segment first enters an AABB.
+/*!
+* \param start The start of the segment.
+* \param end The end of the segment.
+* \param bounds The AABB.
+* \return The distance along the segment in range [0, 1], 0 if start is inside, or <0 if the segment misses.
+*/
+float raycastAABB(sf::Vector2f start, sf::Vector2f end, const AABB& bounds);
+
+//! Find where a line segment first hits a circle.
+/*!
+* \param start The start of the segment.
+* \param end The end of the segment.
+* \param center The center of the circle.
+* \param radius The radius of the circle.
+* \param normal The normal of the circle's surface at the hit point. Zero if start is at the center.
+* \return The distance along the segment in range [0, 1], 0 if start is inside, or <0 if the segment misses.
+*/
+float raycastCircle(sf::Vector2f start, sf::Vector2f end, sf::Vector2f center, float radius, sf::Vector2f& normal);
+
+//! Find where a line segment hits another line segment.
+/*!
+* \param start The start of the first segment.
+* \param end The end of the first segment.
+* \param lineStart The start of the second segment.
+* \param lineEnd The end of the second segment.
+* \param normal The normal of the second segment, facing the start of the first.
+* \return The distance along the first segment in range [0, 1], or <0 if the segments don't intersect.
+*/
+float raycastLine(sf::Vector2f start, sf::Vector2f end, sf::Vector2f lineStart, sf::Vector2f lineEnd, sf::Vector2f& normal);
+
 //! Find the time of collision between a moving circle and a stationary circle.
 /*!
 * \param centerA The center of the first circle.
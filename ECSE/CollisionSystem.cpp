@@ -1,94 +1,211 @@
 #include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <unordered_map>
 #include "TransformSystem.h"
 #include "World.h"
 #include "CollisionSystem.h"
 #include "CollisionMath.h"
 #include "CircleColliderComponent.h"
 #include "LineColliderComponent.h"
+#include "CompoundColliderComponent.h"
 
 namespace ECSE
 {
 
+//! Extra space added around swept bounds so that floating-point error can't hide a collision.
+static const float broadphaseMargin = 1.f;
+
+const size_t Collision::noPart;
+const size_t CollisionSystem::noIsland;
+const size_t CollisionSystem::noCache;
+
+const CollisionSystem::BatchFunction CollisionSystem::batchFunctions[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {
+    //  NONE        CIRCLE                  LINE                COMPOUND
+    {   batchNone,  batchNone,              batchNone,          batchNone   },  // NONE
+    {   batchNone,  batchCircleCircle,      batchCircleLine,    batchNone   },  // CIRCLE
+    {   batchNone,  batchLineCircle,        batchNone,          batchNone   },  // LINE
+    {   batchNone,  batchNone,              batchNone,          batchNone   }   // COMPOUND
+};
+
 void CollisionSystem::advance()
 {
     SetSystem::advance();
 
-    // Collisions before this time have either been dealt with or are invalid
-    float startTime = 0.f;
+    stepClock.restart();
+    broadphaseTime = sf::Time::Zero;
 
-    // Any changes which occurred due to collision response
-    // Initially, consider all entities "changed"
-    ColliderComponent::ChangeSet changes(getEntities());
+    statistics = Statistics();
+    statistics.colliders = shapes.size();
 
-    // Build caches for each Entity.
-    std::vector<EntityCache> caches;
-    for (auto& entity : changes)
+    // Components may have been modified since the last step
+    for (size_t i = 0; i < shapes.size(); ++i)
     {
-        caches.push_back(EntityCache(entity, this));
+        refreshShape(i);
+        updateSleep(i);
     }
 
-    auto potentialCollisions = getPotentialCollisions(caches);
+    if (staticTreeDirty)
+    {
+        rebuildStaticTree();
+        ++statistics.staticTreeRebuilds;
+    }
 
-    while (!changes.empty())
+    // Caches are only rebuilt when Entities come and go. Otherwise, they're just moved to their new positions.
+    if (cachesDirty)
+    {
+        rebuildCaches();
+        ++statistics.cacheRebuilds;
+    }
+    else
     {
-        // Determine time of each collision
-        for (auto& pc : potentialCollisions)
+        for (auto& cache : step.caches)
         {
-            // This collision has to do with an entity which is either unsolved or changed
-            if (pc.time == -1.f ||
-                changes.find(pc.first->entity) != changes.end() ||
-                changes.find(pc.second->entity) != changes.end())
-            {
-                findCollisionTime(pc);
-            }
+            // Caches which were already asleep haven't moved since they were last updated
+            bool asleep = isShapeAsleep(shapes[cache.shape]);
+            if (!asleep || !cache.asleep) cache.update(this, 0.f);
+            cache.asleep = asleep;
         }
-        changes.clear();
+    }
+
+    sleepingCount = 0;
+    for (auto& cache : step.caches)
+    {
+        if (cache.asleep) ++sleepingCount;
+    }
 
-        // Sort by time
-        std::sort(potentialCollisions.begin(), potentialCollisions.end());
+    step.initialBounds.clear();
+    step.staleCaches.clear();
+    for (auto& cache : step.caches)
+    {
+        cache.broadphaseStale = false;
+        step.initialBounds.push_back(cache.bounds);
+    }
+
+    statistics.refreshTime = stepClock.getElapsedTime();
+
+    getPotentialCollisions();
 
-        bool toBreak = false;
+    sf::Clock phaseClock;
+    islandCount = buildIslands();
+    statistics.islandTime = phaseClock.restart();
 
-        // Actually carry out each collision
-        for (auto& pc : potentialCollisions)
+    auto solve = [this](size_t i)
+    {
+        auto& island = step.islands[i];
+        for (size_t pair : island.pairs)
         {
-            // Don't actually break until we've moved to a different time.
-            // This avoids ignoring collisions if they have the same time.
-            if (toBreak && pc.time != startTime) break;
+            schedule(island, pair);
+        }
+        solveScheduled(island);
 
-            if (pc.time < startTime) continue;
+        solveIsland(island, true);
+    };
 
-            ColliderComponent::ChangeSet newChanges = resolve(pc);
-            if (!newChanges.empty())
-            {
-                // Something changed, so we have to check for collisions again once this time is dealt with
-                startTime = pc.time;
-                changes.insert(newChanges.begin(), newChanges.end());
-                toBreak = true;
-            }
+    if (workerPool)
+    {
+        workerPool->run(islandCount, solve);
+    }
+    else
+    {
+        for (size_t i = 0; i < islandCount; ++i)
+        {
+            solve(i);
         }
+    }
+
+    // Entities which left their islands may now hit anything, so finish those islands together.
+    // This always happens in island order, so it doesn't depend on how the islands were scheduled.
+    auto& remaining = step.remaining;
+    remaining.reset(islandCount);
+    bool anyEscaped = false;
+    for (size_t i = 0; i < islandCount; ++i)
+    {
+        remaining.round = std::max(remaining.round, step.islands[i].round + 1);
+    }
+
+    for (size_t i = 0; i < islandCount; ++i)
+    {
+        auto& island = step.islands[i];
+        if (!island.escaped) continue;
 
-        // Update caches
-        if (!changes.empty())
+        while (!island.impacts.empty())
         {
-            for (auto& cache : caches)
-            {
-                if (changes.find(cache.entity) != changes.end())
-                {
-                    cache.update(this, startTime);
-                }
-            }
+            remaining.impacts.push(island.impacts.top());
+            island.impacts.pop();
         }
+
+        applyChanges(remaining, island.changes, island.startTime);
+        remaining.resolvedRounds = std::max(remaining.resolvedRounds, island.resolvedRounds);
+        anyEscaped = true;
+    }
+
+    // The remaining island's rounds carry on from the escaped ones, so only its own are counted
+    unsigned carriedRounds = remaining.resolvedRounds;
+    if (anyEscaped)
+    {
+        solveIsland(remaining, false);
+    }
+
+    overflowCount = remaining.overflowed ? 1 : 0;
+    for (size_t i = 0; i < islandCount; ++i)
+    {
+        if (step.islands[i].overflowed) ++overflowCount;
+    }
+
+    if (overflowCount > 0)
+    {
+        totalOverflowCount += overflowCount;
+        VLOG(1) << overflowCount << " collision islands ran out of budget";
+    }
+
+    // Gather contacts in island order, so they don't depend on how the islands were scheduled either
+    contacts.clear();
+    for (size_t i = 0; i < islandCount; ++i)
+    {
+        auto& islandContacts = step.islands[i].contacts;
+        contacts.insert(contacts.end(), islandContacts.begin(), islandContacts.end());
+    }
+    contacts.insert(contacts.end(), remaining.contacts.begin(), remaining.contacts.end());
+
+    statistics.solveTime = phaseClock.restart();
+
+    updateSensors();
+
+    statistics.sensorTime = phaseClock.restart();
+
+    pairCount = step.collisions.size();
+
+    statistics.pairs = pairCount;
+    statistics.hits = contacts.size();
+    statistics.islands = islandCount;
+    statistics.rounds = remaining.resolvedRounds - carriedRounds;
+    statistics.narrowphaseTests = remaining.narrowphaseTests;
+    statistics.narrowphaseTime = remaining.narrowphaseTime;
+    for (size_t i = 0; i < islandCount; ++i)
+    {
+        statistics.rounds += step.islands[i].resolvedRounds;
+        statistics.narrowphaseTests += step.islands[i].narrowphaseTests;
+        statistics.narrowphaseTime += step.islands[i].narrowphaseTime;
+    }
+    statistics.broadphaseTime = broadphaseTime;
+    statistics.totalTime = stepClock.getElapsedTime();
+
+    if (logStatistics)
+    {
+        LOG(INFO) << "Collision step: " << statistics;
     }
+
+    // Everything is about to be moved by the TransformSystem
+    queryTreeDirty = true;
 }
 
 bool CollisionSystem::checkRequirements(const Entity& e) const
 {
-    if (!e.getComponent<TransformComponent>()) return false;
-
-    // Need one of these
+    // The signature covers the transform and collider, but the collider needs to be one of these
     if (e.getComponent<CircleColliderComponent>()) return true;
     if (e.getComponent<LineColliderComponent>()) return true;
+    if (e.getComponent<CompoundColliderComponent>()) return true;
 
     return false;
 }
@@ -108,6 +225,14 @@ void CollisionSystem::added()
     }
 }
 
+bool CollisionSystem::isAsleep(const Entity& e) const
+{
+    auto it = shapeIndices.find(const_cast<Entity*>(&e));
+    if (it == shapeIndices.end()) return false;
+
+    return isShapeAsleep(shapes[it->second]);
+}
+
 sf::Vector2f CollisionSystem::getColliderPosition(const Entity& e) const
 {
     auto collider = e.getComponent<ColliderComponent>();
@@ -138,208 +263,1570 @@ sf::Vector2f CollisionSystem::getNextColliderPosition(const Entity& e) const
     return transformSystem->getNextGlobalPosition(e) + collOffset;
 }
 
-std::vector<CollisionSystem::PotentialCollision> CollisionSystem::getPotentialCollisions(std::vector<EntityCache>& caches) const
+void CollisionSystem::internalAddEntity(Entity& e)
 {
-    std::vector<PotentialCollision> collisions;
+    SetSystem::internalAddEntity(e);
 
-    // First entity in the collision
-    auto cacheA = caches.begin();
+    addShape(e);
+    cachesDirty = true;
+    queryTreeDirty = true;
 
-    while (cacheA != caches.end())
+    if (shapes.back().isStatic)
     {
-        // Second entity in the collision
-        auto cacheB = std::next(cacheA);
+        staticEntities.insert(&e);
+        staticTreeDirty = true;
+    }
+}
 
-        while (cacheB != caches.end())
-        {
-            // These two entities are able to collide
-            collisions.push_back(PotentialCollision(&*cacheA, &*cacheB));
+void CollisionSystem::internalRemoveEntity(Entity& e)
+{
+    SetSystem::internalRemoveEntity(e);
 
-            ++cacheB;
-        }
+    auto it = shapeIndices.find(&e);
+    if (it != shapeIndices.end())
+    {
+        removeShape(it->second);
+        cachesDirty = true;
+        queryTreeDirty = true;
+    }
 
-        ++cacheA;
+    if (staticEntities.erase(&e))
+    {
+        staticTreeDirty = true;
     }
 
-    return collisions;
+    // The Entity may be about to be destroyed, so its overlaps are forgotten rather than reported
+    sensorContacts.erase(std::remove_if(sensorContacts.begin(), sensorContacts.end(),
+                                        [&e](const SensorContact& contact)
+    {
+        return contact.first == &e || contact.second == &e;
+    }), sensorContacts.end());
 }
 
-// http://www.gamasutra.com/view/feature/131424/pool_hall_lessons_fast_accurate_.php?page=2
-void CollisionSystem::findCollisionTime(PotentialCollision& pc) const
+void CollisionSystem::addShape(Entity& e)
 {
-    auto colliderA = pc.first->collider;
-    auto colliderB = pc.second->collider;
+    ColliderShape shape;
+    shape.entity = &e;
+    shape.transform = e.getComponent<TransformComponent>();
+    shape.typeIndex = 0;
+    shape.enabled = false;
+    shape.layer = 0;
+    shape.mask = 0;
+    shape.filterVersion = 0;
+    shape.transformVersion = shape.transform->getVersion();
+    shape.stillSteps = 0;
 
-    bool aHasCollider = (colliderA && colliderA->enabled);
-    bool bHasCollider = (colliderB && colliderB->enabled);
+    size_t index = shapes.size();
 
-    auto typeA = pc.first->type;
-    auto typeB = pc.second->type;
-
-    // No colliders
-    if (!aHasCollider || !bHasCollider)
+    auto circle = e.getComponent<CircleColliderComponent>();
+    auto line = e.getComponent<LineColliderComponent>();
+    auto compound = e.getComponent<CompoundColliderComponent>();
+    if (circle != nullptr)
     {
-        pc.time = -1.f;
-        return;
+        shape.collider = circle;
+        shape.type = CIRCLE;
+        shape.typeIndex = circleShapes.size();
+        circleShapes.push_back(CircleShape{ circle->radius, index, Collision::noPart });
+    }
+    else if (line != nullptr)
+    {
+        shape.collider = line;
+        shape.type = LINE;
+        shape.typeIndex = lineShapes.size();
+        lineShapes.push_back(LineShape{ line->vec, index, Collision::noPart });
+    }
+    else if (compound != nullptr)
+    {
+        // The parts are added when the shape is refreshed
+        shape.collider = compound;
+        shape.type = COMPOUND;
+        shape.typeIndex = compoundShapes.size();
+        compoundShapes.push_back(CompoundShape{ {}, index });
+    }
+    else
+    {
+        shape.collider = e.getComponent<ColliderComponent>();
+        shape.type = NONE;
     }
-    
-    // If one of the start times is non-zero, then we're dealing with a collision in a smaller
-    // time scale, e.g. if maxStartTime is 0.3, then the collision can only take place in the
-    // last 0.7 units of our frame
-    float startTimeA = pc.first->startTime;
-    float startTimeB = pc.second->startTime;
 
-    float maxStartTime = std::max(startTimeA, startTimeB);
-    float timeScale = 1.f - maxStartTime;
+    shape.response = ColliderComponent::NONE;
+    shape.restitution = 1.f;
+    shape.isStatic = shape.collider && shape.collider->isStatic;
+    shape.isSensor = shape.collider && shape.collider->isSensor;
 
-    sf::Vector2f startA = pc.first->start;
-    sf::Vector2f endA = pc.first->end;
-    sf::Vector2f startB = pc.second->start;
-    sf::Vector2f endB = pc.second->end;
+    shapes.push_back(shape);
+    shapeIndices[&e] = index;
+
+    refreshShape(index);
+}
 
-    // If one start time is greater than the other, then we also need to interpolate the position
-    // of the "earlier" object so they both start at the same time.
-    if (startTimeA < startTimeB)
+void CollisionSystem::removeShape(size_t index)
+{
+    // Swap and pop the shape parameters, then the ColliderShape itself
+    auto& shape = shapes[index];
+    if (shape.type == CIRCLE || shape.type == LINE)
     {
-        float lerpAmt = timeScale == 0.f ? 1.f : (startTimeB - startTimeA) / timeScale;
-        lerpAmt = ECSE::clamp(0.f, 1.f, lerpAmt);
-        startA = ECSE::lerp(startA, endA, lerpAmt);
+        removeTyped(shape.type, shape.typeIndex);
     }
-    else if (startTimeB < startTimeA)
+    else if (shape.type == COMPOUND)
     {
-        float lerpAmt = timeScale == 0.f ? 1.f : (startTimeA - startTimeB) / timeScale;
-        lerpAmt = ECSE::clamp(0.f, 1.f, lerpAmt);
-        startB = ECSE::lerp(startB, endB, lerpAmt);
+        auto& parts = compoundShapes[shape.typeIndex].parts;
+        while (!parts.empty())
+        {
+            removeTyped(parts.back().type, parts.back().typeIndex);
+            parts.pop_back();
+        }
+
+        if (shape.typeIndex != compoundShapes.size() - 1)
+        {
+            compoundShapes[shape.typeIndex] = std::move(compoundShapes.back());
+            shapes[compoundShapes[shape.typeIndex].shape].typeIndex = shape.typeIndex;
+        }
+        compoundShapes.pop_back();
     }
 
-    // Work with relative motion rather than absoute motion to reduce the
-    // problem to one moving collider and one stationary
-    sf::Vector2f moveVec = (endA - startA) - (endB - startB);
+    shapeIndices.erase(shape.entity);
 
-    // Circle-circle collision
-    if (typeA == EntityCache::CIRCLE && typeB == EntityCache::CIRCLE)
+    if (index != shapes.size() - 1)
     {
-        auto circleA = dynamic_cast<CircleColliderComponent*>(pc.first->collider);
-        auto circleB = dynamic_cast<CircleColliderComponent*>(pc.second->collider);
+        shapes[index] = shapes.back();
 
-        circleCircle(startA, circleA->radius, startB, circleB->radius, moveVec,
-                     pc.time, pc.normal);
+        auto& moved = shapes[index];
+        shapeIndices[moved.entity] = index;
+        if (moved.type == CIRCLE) circleShapes[moved.typeIndex].shape = index;
+        else if (moved.type == LINE) lineShapes[moved.typeIndex].shape = index;
+        else if (moved.type == COMPOUND)
+        {
+            auto& compound = compoundShapes[moved.typeIndex];
+            compound.shape = index;
+            for (auto& part : compound.parts)
+            {
+                if (part.type == CIRCLE) circleShapes[part.typeIndex].shape = index;
+                else lineShapes[part.typeIndex].shape = index;
+            }
+        }
     }
-    // Circle-line collision
-    else if (typeA == EntityCache::CIRCLE && typeB == EntityCache::LINE)
+
+    shapes.pop_back();
+}
+
+void CollisionSystem::removeTyped(ShapeType type, size_t typeIndex)
+{
+    // Swap and pop, then point whatever owns the moved parameters at their new index
+    auto swapAndPop = [this, typeIndex](auto& typed)
+    {
+        typed[typeIndex] = typed.back();
+        typed.pop_back();
+        if (typeIndex == typed.size()) return;
+
+        auto& moved = typed[typeIndex];
+        auto& owner = shapes[moved.shape];
+        if (moved.part == Collision::noPart) owner.typeIndex = typeIndex;
+        else compoundShapes[owner.typeIndex].parts[moved.part].typeIndex = typeIndex;
+    };
+
+    if (type == CIRCLE) swapAndPop(circleShapes);
+    else if (type == LINE) swapAndPop(lineShapes);
+}
+
+size_t CollisionSystem::countKeptParts(size_t index) const
+{
+    auto& compound = compoundShapes[shapes[index].typeIndex];
+    auto& parts = static_cast<CompoundColliderComponent*>(shapes[index].collider)->parts;
+
+    auto sameType = [](const CompoundPart& part, const CompoundColliderComponent::Part& componentPart)
     {
-        auto circleA = dynamic_cast<CircleColliderComponent*>(pc.first->collider);
-        auto lineB = dynamic_cast<LineColliderComponent*>(pc.second->collider);
+        return part.type == (componentPart.type == CompoundColliderComponent::Part::CIRCLE ? CIRCLE : LINE);
+    };
 
-        circleLine(startA, circleA->radius, startB, startB + lineB->vec, moveVec,
-                   pc.time, pc.normal);
+    // Parts can be updated in place until the first one whose type changed
+    size_t kept = 0;
+    while (kept < compound.parts.size() && kept < parts.size() && sameType(compound.parts[kept], parts[kept]))
+    {
+        ++kept;
     }
-    // Line-circle collision
-    else if (typeA == EntityCache::LINE && typeB == EntityCache::CIRCLE)
+
+    return kept;
+}
+
+bool CollisionSystem::hasPartsChanged(size_t index) const
+{
+    auto& shape = shapes[index];
+    if (shape.type != COMPOUND || shape.collider == nullptr) return false;
+
+    size_t kept = countKeptParts(index);
+    return kept != compoundShapes[shape.typeIndex].parts.size() ||
+           kept != static_cast<CompoundColliderComponent*>(shape.collider)->parts.size();
+}
+
+bool CollisionSystem::refreshCompound(size_t index)
+{
+    auto& compound = compoundShapes[shapes[index].typeIndex];
+    auto& parts = static_cast<CompoundColliderComponent*>(shapes[index].collider)->parts;
+
+    auto getType = [](const CompoundColliderComponent::Part& part)
     {
-        auto lineA = dynamic_cast<LineColliderComponent*>(pc.first->collider);
-        auto circleB = dynamic_cast<CircleColliderComponent*>(pc.second->collider);
+        return part.type == CompoundColliderComponent::Part::CIRCLE ? CIRCLE : LINE;
+    };
+
+    size_t kept = countKeptParts(index);
+    bool changed = kept != compound.parts.size() || kept != parts.size();
 
-        circleLine(startB, circleB->radius, startA, startA + lineA->vec, -moveVec,
-                   pc.time, pc.normal);
+    while (compound.parts.size() > kept)
+    {
+        removeTyped(compound.parts.back().type, compound.parts.back().typeIndex);
+        compound.parts.pop_back();
     }
-    else
+
+    for (size_t i = kept; i < parts.size(); ++i)
     {
-        // No collision detection for this pair of types (yet?)
-        pc.time = -1.f;
-        return;
+        CompoundPart part{ getType(parts[i]), 0, parts[i].offset };
+        if (part.type == CIRCLE)
+        {
+            part.typeIndex = circleShapes.size();
+            circleShapes.push_back(CircleShape{ parts[i].radius, index, i });
+        }
+        else
+        {
+            part.typeIndex = lineShapes.size();
+            lineShapes.push_back(LineShape{ parts[i].vec, index, i });
+        }
+        compound.parts.push_back(part);
     }
 
-    // If we started this collision check at a later time than 0.f, then we need to modify
-    // the time value accordingly. Note that if maxStartTime is 0.f, nothing happens here.
-    if (pc.time > 0.f)
-        pc.time = maxStartTime + timeScale * pc.time;
+    for (size_t i = 0; i < kept; ++i)
+    {
+        auto& part = compound.parts[i];
+        changed = changed || part.offset != parts[i].offset;
+        part.offset = parts[i].offset;
+
+        if (part.type == CIRCLE)
+        {
+            auto& circle = circleShapes[part.typeIndex];
+            changed = changed || circle.radius != parts[i].radius;
+            circle.radius = parts[i].radius;
+        }
+        else
+        {
+            auto& line = lineShapes[part.typeIndex];
+            changed = changed || line.vec != parts[i].vec;
+            line.vec = parts[i].vec;
+        }
+    }
 
-    return;
+    return changed;
 }
 
-ColliderComponent::ChangeSet CollisionSystem::resolve(const PotentialCollision& pc) const
+void CollisionSystem::refreshShape(size_t index)
 {
-    auto colliderA = pc.first->collider;
-    auto colliderB = pc.second->collider;
+    auto& shape = shapes[index];
+    auto collider = shape.collider;
 
-    // May have been disabled in the middle of collision detection
-    if (!colliderA->enabled || !colliderB->enabled) return {};
+    if (collider == nullptr)
+    {
+        shape.enabled = false;
+        return;
+    }
 
-    // Build the collision
-    float firstTime = pc.first->startTime;
-    float secondTime = pc.second->startTime;
+    bool changed = shape.offset != collider->offset || shape.enabled != collider->enabled ||
+                   shape.filterVersion != collider->getFilterVersion();
 
-    auto collision = Collision(pc.first->entity,
-                               pc.second->entity,
-                               pc.time,
+    shape.offset = collider->offset;
+    shape.enabled = collider->enabled;
+    shape.layer = collider->getLayer();
+    shape.mask = collider->getMask();
+    shape.filterVersion = collider->getFilterVersion();
+    shape.response = collider->response;
+    shape.restitution = collider->restitution;
 
-                               // We need to scale the time here to account for changing positions in mid-frame
-                               transformSystem->getInterpGlobalPosition(
-                                   *pc.first->entity,
-                                   firstTime == 1.f ? 1.f : (pc.time - firstTime) / (1 - firstTime)
-                               ),
-                               transformSystem->getInterpGlobalPosition(
-                                   *pc.second->entity,
-                                   secondTime == 1.f ? 1.f : (pc.time - secondTime) / (1 - secondTime)
-                               ),
+    if (shape.type == CIRCLE)
+    {
+        auto& circle = circleShapes[shape.typeIndex];
+        float radius = static_cast<CircleColliderComponent*>(collider)->radius;
+        changed = changed || circle.radius != radius;
+        circle.radius = radius;
+    }
+    else if (shape.type == LINE)
+    {
+        auto& line = lineShapes[shape.typeIndex];
+        auto& vec = static_cast<LineColliderComponent*>(collider)->vec;
+        changed = changed || line.vec != vec;
+        line.vec = vec;
+    }
+    else if (shape.type == COMPOUND)
+    {
+        changed = refreshCompound(index) || changed;
+    }
 
-                               pc.normal);
-    
-    ColliderComponent::ChangeSet changes;
-    auto newChanges = colliderA->callCallbacks(collision);
-    changes.insert(newChanges.begin(), newChanges.end());
+    if (changed) shape.stillSteps = 0;
+}
 
-    // Invert it for the second entity so it sees colliderB as itself
-    collision.invert();
+void CollisionSystem::updateSleep(size_t index)
+{
+    auto& shape = shapes[index];
+    auto transform = shape.transform;
 
-    newChanges = colliderB->callCallbacks(collision);
-    changes.insert(newChanges.begin(), newChanges.end());
+    // Any write to the transform counts as a change, even if it didn't actually move anything
+    bool still = transform->getVersion() == shape.transformVersion &&
+                 transform->getLocalDeltaPosition() == sf::Vector2f() &&
+                 transform->getLocalDeltaAngle() == 0.f &&
+                 transform->getParent() == Entity::invalidID;
+    shape.transformVersion = transform->getVersion();
 
-    return changes;
+    if (!still) shape.stillSteps = 0;
+    else if (shape.stillSteps < sleepSteps) ++shape.stillSteps;
 }
 
-CollisionSystem::EntityCache::EntityCache(Entity* entity, CollisionSystem* cs)
-    : entity(entity)
+sf::Vector2f CollisionSystem::getShapePosition(const ColliderShape& shape, bool next) const
 {
-    setupCollider();
-    update(cs, 0.f);
+    auto transform = shape.transform;
+
+    // Parented transforms need the whole chain, so only the common case avoids the TransformSystem
+    if (transform->getParent() != Entity::invalidID)
+    {
+        return next ? getNextColliderPosition(*shape.entity) : getColliderPosition(*shape.entity);
+    }
+
+    auto collOffset = shape.offset;
+    rotate(collOffset, next ? transform->getNextLocalAngle() : transform->getLocalAngle());
+
+    return (next ? transform->getNextLocalPosition() : transform->getLocalPosition()) + collOffset;
 }
 
-void CollisionSystem::EntityCache::update(CollisionSystem* cs, float time)
+void CollisionSystem::setBroadphase(std::unique_ptr<Broadphase> newBroadphase)
 {
-    startTime = time;
-    start = cs->getColliderPosition(*entity);
-
-    if (entity->getComponent<TransformComponent>()->isPositionDiscrete())
+    if (!newBroadphase)
     {
-        end = start;
+        throw std::runtime_error("CollisionSystem requires a Broadphase");
     }
-    else
+
+    broadphase = std::move(newBroadphase);
+}
+
+void CollisionSystem::rebuildStaticTree()
+{
+    staticCaches.clear();
+    staticCaches.reserve(staticEntities.size());
+    staticSensors.clear();
+
+    std::vector<AABB> bounds;
+    bounds.reserve(staticEntities.size());
+
+    for (auto& entity : staticEntities)
     {
-        end = cs->getNextColliderPosition(*entity);
+        staticCaches.push_back(EntityCache(shapeIndices.at(entity), this, true));
+        staticCaches.back().index = staticCaches.size() - 1;
+        bounds.push_back(staticCaches.back().bounds);
+
+        if (shapes[staticCaches.back().shape].isSensor) staticSensors.push_back(staticCaches.size() - 1);
     }
+
+    staticTree.build(bounds);
+    staticTreeDirty = false;
+
+    VLOG(1) << "Built static collider hierarchy with " << staticCaches.size() << " colliders";
 }
 
-void CollisionSystem::EntityCache::setupCollider()
+void CollisionSystem::prepareQueries()
 {
-    auto circle = entity->getComponent<CircleColliderComponent>();
-    if (circle != nullptr)
+    if (staticTreeDirty)
     {
-        collider = circle;
-        type = CIRCLE;
-        return;
+        rebuildStaticTree();
     }
 
-    auto line = entity->getComponent<LineColliderComponent>();
-    if (line != nullptr)
+    if (cachesDirty)
     {
-        collider = line;
-        type = LINE;
-        return;
+        rebuildCaches();
+    }
+
+    if (!queryTreeDirty) return;
+
+    queryBounds.clear();
+    queryPositions.clear();
+    for (auto& cache : step.caches)
+    {
+        // Components may have been modified since the last step
+        refreshShape(cache.shape);
+
+        auto& shape = shapes[cache.shape];
+        queryPositions.push_back(getShapePosition(shape, false));
+        queryBounds.push_back(getShapeBounds(shape, queryPositions.back()));
     }
 
-    collider = nullptr;
+    queryTree.build(queryBounds);
+    queryTreeDirty = false;
+}
+
+bool CollisionSystem::raycast(sf::Vector2f start, sf::Vector2f end, QueryHit& hit, std::uint32_t mask)
+{
+    prepareQueries();
+
+    const ColliderShape* bestShape = nullptr;
+    float bestTime = std::numeric_limits<float>::max();
+    sf::Vector2f bestNormal;
+    size_t bestPart = Collision::noPart;
+
+    auto test = [&](const ColliderShape& shape, sf::Vector2f position)
+    {
+        if (!matchesQuery(shape, mask)) return -1.f;
+
+        sf::Vector2f normal;
+        size_t part;
+        float time = raycastShape(shape, position, start, end, normal, part);
+        if (time >= 0.f && time < bestTime)
+        {
+            bestShape = &shape;
+            bestTime = time;
+            bestNormal = normal;
+            bestPart = part;
+        }
+
+        return time;
+    };
+
+    float time;
+    staticTree.raycast(start, end, [&](size_t index)
+    {
+        return test(shapes[staticCaches[index].shape], staticCaches[index].start);
+    }, time);
+    queryTree.raycast(start, end, [&](size_t index)
+    {
+        return test(shapes[step.caches[index].shape], queryPositions[index]);
+    }, time);
+
+    if (bestShape == nullptr) return false;
+
+    hit.entity = bestShape->entity;
+    hit.distance = getMagnitude(end - start) * bestTime;
+    hit.position = lerp(start, end, bestTime);
+    hit.normal = bestNormal;
+    hit.part = bestPart;
+    return true;
+}
+
+void CollisionSystem::overlapCircle(sf::Vector2f center, float radius, std::vector<Entity*>& results, std::uint32_t mask)
+{
+    results.clear();
+    prepareQueries();
+
+    AABB bounds;
+    bounds.include(center);
+    bounds.pad(radius);
+
+    forEachQueryCandidate(bounds, [&](const ColliderShape& shape, sf::Vector2f position)
+    {
+        if (!matchesQuery(shape, mask)) return;
+
+        sf::Vector2f closest;
+        size_t part;
+        if (getShapeDistance(shape, position, center, closest, part) <= radius) results.push_back(shape.entity);
+    });
+}
+
+void CollisionSystem::overlapAABB(const AABB& bounds, std::vector<Entity*>& results, std::uint32_t mask)
+{
+    results.clear();
+    prepareQueries();
+
+    forEachQueryCandidate(bounds, [&](const ColliderShape& shape, sf::Vector2f position)
+    {
+        if (!matchesQuery(shape, mask)) return;
+
+        bool overlaps = false;
+        forEachPart(shape, position, [&](ShapeType type, size_t typeIndex, sf::Vector2f partPosition, size_t)
+        {
+            if (type == CIRCLE)
+            {
+                sf::Vector2f closest(clamp(bounds.min.x, bounds.max.x, partPosition.x),
+                                     clamp(bounds.min.y, bounds.max.y, partPosition.y));
+                float radius = circleShapes[typeIndex].radius;
+                overlaps = overlaps || getSqrMagnitude(partPosition - closest) <= radius * radius;
+            }
+            else if (type == LINE)
+            {
+                overlaps = overlaps || raycastAABB(partPosition, partPosition + lineShapes[typeIndex].vec, bounds) >= 0.f;
+            }
+        });
+
+        if (overlaps) results.push_back(shape.entity);
+    });
+}
+
+bool CollisionSystem::nearest(sf::Vector2f point, QueryHit& hit, std::uint32_t mask, float maxDistance)
+{
+    prepareQueries();
+
+    const ColliderShape* bestShape = nullptr;
+    float bestDistance = maxDistance;
+    sf::Vector2f bestPosition;
+    size_t bestPart = Collision::noPart;
+
+    auto test = [&](const ColliderShape& shape, sf::Vector2f position)
+    {
+        if (!matchesQuery(shape, mask)) return -1.f;
+
+        sf::Vector2f closest;
+        size_t part;
+        float distance = getShapeDistance(shape, position, point, closest, part);
+        if (distance < bestDistance)
+        {
+            bestShape = &shape;
+            bestDistance = distance;
+            bestPosition = closest;
+            bestPart = part;
+        }
+
+        return distance;
+    };
+
+    float distance;
+    staticTree.nearest(point, maxDistance, [&](size_t index)
+    {
+        return test(shapes[staticCaches[index].shape], staticCaches[index].start);
+    }, distance);
+    queryTree.nearest(point, bestDistance, [&](size_t index)
+    {
+        return test(shapes[step.caches[index].shape], queryPositions[index]);
+    }, distance);
+
+    if (bestShape == nullptr) return false;
+
+    hit.entity = bestShape->entity;
+    hit.distance = bestDistance;
+    hit.position = bestPosition;
+    hit.normal = point - bestPosition;
+    if (bestDistance > 0.f) normalize(hit.normal);
+    hit.part = bestPart;
+    return true;
+}
+
+AABB CollisionSystem::getShapeBounds(const ColliderShape& shape, sf::Vector2f position) const
+{
+    AABB bounds;
+    bounds.include(position);
+
+    forEachPart(shape, position, [&](ShapeType type, size_t typeIndex, sf::Vector2f partPosition, size_t)
+    {
+        includePart(bounds, type, typeIndex, partPosition);
+    });
+
+    return bounds;
+}
+
+void CollisionSystem::includePart(AABB& bounds, ShapeType type, size_t typeIndex, sf::Vector2f position) const
+{
+    if (type == CIRCLE)
+    {
+        float radius = circleShapes[typeIndex].radius;
+        bounds.include(position - sf::Vector2f(radius, radius));
+        bounds.include(position + sf::Vector2f(radius, radius));
+    }
+    else if (type == LINE)
+    {
+        bounds.include(position);
+        bounds.include(position + lineShapes[typeIndex].vec);
+    }
+    else
+    {
+        bounds.include(position);
+    }
+}
+
+float CollisionSystem::raycastShape(const ColliderShape& shape, sf::Vector2f position, sf::Vector2f start,
+                                   sf::Vector2f end, sf::Vector2f& normal, size_t& part) const
+{
+    float bestTime = -1.f;
+    part = Collision::noPart;
+
+    forEachPart(shape, position, [&](ShapeType type, size_t typeIndex, sf::Vector2f partPosition, size_t partIndex)
+    {
+        sf::Vector2f partNormal;
+        float time = -1.f;
+
+        if (type == CIRCLE)
+        {
+            time = raycastCircle(start, end, partPosition, circleShapes[typeIndex].radius, partNormal);
+        }
+        else if (type == LINE)
+        {
+            time = raycastLine(start, end, partPosition, partPosition + lineShapes[typeIndex].vec, partNormal);
+        }
+
+        if (time >= 0.f && (bestTime < 0.f || time < bestTime))
+        {
+            bestTime = time;
+            normal = partNormal;
+            part = partIndex;
+        }
+    });
+
+    return bestTime;
+}
+
+float CollisionSystem::getShapeDistance(const ColliderShape& shape, sf::Vector2f position, sf::Vector2f point,
+                                        sf::Vector2f& closest, size_t& part) const
+{
+    // A compound collider without parts can't be found
+    float bestDistance = std::numeric_limits<float>::max();
+    closest = position;
+    part = Collision::noPart;
+
+    forEachPart(shape, position, [&](ShapeType type, size_t typeIndex, sf::Vector2f partPosition, size_t partIndex)
+    {
+        sf::Vector2f partClosest;
+        float distance = getPartDistance(type, typeIndex, partPosition, point, partClosest);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            closest = partClosest;
+            part = partIndex;
+        }
+    });
+
+    return bestDistance;
+}
+
+float CollisionSystem::getPartDistance(ShapeType type, size_t typeIndex, sf::Vector2f position, sf::Vector2f point,
+                                       sf::Vector2f& closest) const
+{
+    if (type == CIRCLE)
+    {
+        sf::Vector2f toPoint = point - position;
+        float radius = circleShapes[typeIndex].radius;
+        float distance = getMagnitude(toPoint) - radius;
+
+        if (distance <= 0.f)
+        {
+            closest = point;
+            return 0.f;
+        }
+
+        closest = position + setMagnitude(toPoint, radius);
+        return distance;
+    }
+    else if (type == LINE)
+    {
+        closest = findClosestPointOnLine(point, position, position + lineShapes[typeIndex].vec);
+        return getMagnitude(point - closest);
+    }
+
+    closest = position;
+    return getMagnitude(point - closest);
+}
+
+void CollisionSystem::rebuildCaches()
+{
+    auto& caches = step.caches;
+    caches.clear();
+    caches.reserve(shapes.size() - staticEntities.size());
+    step.shapeCaches.assign(shapes.size(), noCache);
+    step.sensorCaches.clear();
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        if (shapes[i].isStatic) continue;
+
+        step.shapeCaches[i] = caches.size();
+        caches.push_back(EntityCache(i, this));
+        caches.back().index = caches.size() - 1;
+        caches.back().asleep = isShapeAsleep(shapes[i]);
+
+        if (shapes[i].isSensor) step.sensorCaches.push_back(caches.size() - 1);
+    }
+
+    // Removing an Entity moves another into its place, which may be a static one
+    for (auto& cache : staticCaches)
+    {
+        cache.shape = shapeIndices.at(cache.entity);
+    }
+
+    step.cachePairs.resize(caches.size());
+    cachesDirty = false;
+}
+
+size_t CollisionSystem::findCache(Entity* entity) const
+{
+    auto it = shapeIndices.find(entity);
+    if (it == shapeIndices.end()) return noCache;
+
+    return step.shapeCaches[it->second];
+}
+
+bool CollisionSystem::isSharedStatic(Entity* entity) const
+{
+    auto it = shapeIndices.find(entity);
+    if (it == shapeIndices.end()) return false;
+
+    auto& shape = shapes[it->second];
+    return shape.isStatic && !shape.collider->hasCallbacks();
+}
+
+void CollisionSystem::getPotentialCollisions()
+{
+    sf::Clock clock;
+
+    auto& caches = step.caches;
+    auto& collisions = step.collisions;
+    collisions.clear();
+
+    for (auto& pairs : step.cachePairs)
+    {
+        pairs.clear();
+    }
+
+    broadphase->findPairs(step.initialBounds, step.broadphasePairs);
+
+    for (auto& pair : step.broadphasePairs)
+    {
+        // Sleeping colliders are only checked against awake ones
+        if (caches[pair.first].asleep && caches[pair.second].asleep) continue;
+        if (!canCollide(caches[pair.first], caches[pair.second])) continue;
+
+        // These two entities are able to collide
+        collisions.push_back(PotentialCollision(&caches[pair.first], &caches[pair.second]));
+    }
+
+    // Static colliders only need to be checked against moving ones
+    for (auto& cache : caches)
+    {
+        if (cache.asleep) continue;
+
+        staticTree.query(cache.bounds, step.queryResults);
+        for (size_t other : step.queryResults)
+        {
+            if (!canCollide(cache, staticCaches[other])) continue;
+
+            collisions.push_back(PotentialCollision(&cache, &staticCaches[other]));
+        }
+    }
+
+    // The pairs each moving cache is part of, so a change only invalidates the pairs it touches
+    for (size_t i = 0; i < collisions.size(); ++i)
+    {
+        auto& pc = collisions[i];
+        step.cachePairs[pc.first->index].push_back(i);
+        if (!pc.second->isStatic) step.cachePairs[pc.second->index].push_back(i);
+    }
+
+    broadphaseTime += clock.getElapsedTime();
+}
+
+void CollisionSystem::addPotentialCollisions(const std::vector<size_t>& changed)
+{
+    sf::Clock clock;
+
+    auto& caches = step.caches;
+    auto& stale = step.staleCaches;
+    auto& results = step.queryResults;
+
+    for (size_t index : changed)
+    {
+        if (!caches[index].broadphaseStale)
+        {
+            caches[index].broadphaseStale = true;
+            stale.push_back(index);
+        }
+    }
+
+    auto tryPair = [&](size_t a, size_t b)
+    {
+        if (a == b || !caches[a].bounds.overlaps(caches[b].bounds)) return;
+        if (!canCollide(caches[a], caches[b])) return;
+
+        addPair(caches[std::min(a, b)], caches[std::max(a, b)]);
+    };
+
+    for (size_t index : changed)
+    {
+        // The Broadphase still knows where unchanged caches are...
+        broadphase->query(caches[index].bounds, results);
+        for (size_t other : results)
+        {
+            if (!caches[other].broadphaseStale) tryPair(index, other);
+        }
+
+        // ...but stale caches have to be checked directly
+        for (size_t other : stale)
+        {
+            tryPair(index, other);
+        }
+
+        // Static colliders never go stale
+        staticTree.query(caches[index].bounds, results);
+        for (size_t other : results)
+        {
+            if (!canCollide(caches[index], staticCaches[other])) continue;
+
+            addPair(caches[index], staticCaches[other]);
+        }
+    }
+
+    broadphaseTime += clock.getElapsedTime();
+}
+
+void CollisionSystem::addPair(EntityCache& a, EntityCache& b)
+{
+    // Caches are only in a few pairs each, so this is cheaper than keeping a set of every pair
+    for (size_t pair : step.cachePairs[a.index])
+    {
+        auto& pc = step.collisions[pair];
+        if (pc.first == &b || pc.second == &b) return;
+    }
+
+    size_t pair = step.collisions.size();
+    step.collisions.push_back(PotentialCollision(&a, &b));
+
+    step.cachePairs[a.index].push_back(pair);
+    if (!b.isStatic) step.cachePairs[b.index].push_back(pair);
+}
+
+void CollisionSystem::updateSensors()
+{
+    sensorEvents.clear();
+    newSensorContacts.clear();
+
+    if (step.sensorCaches.empty() && staticSensors.empty() && sensorContacts.empty()) return;
+
+    auto& caches = step.caches;
+    auto& results = step.queryResults;
+
+    auto findContacts = [&](const EntityCache& sensor)
+    {
+        auto& sensorShape = shapes[sensor.shape];
+        if (!sensorShape.enabled) return;
+
+        AABB bounds = getShapeBounds(sensorShape, sensor.end);
+
+        auto tryContact = [&](const EntityCache& other)
+        {
+            auto& otherShape = shapes[other.shape];
+            if (otherShape.isSensor || !otherShape.enabled || !canOverlap(sensorShape, otherShape)) return;
+            if (!shapesOverlap(sensorShape, sensor.end, otherShape, other.end)) return;
+
+            newSensorContacts.push_back(SensorContact(sensor.entity, other.entity));
+        };
+
+        // The Broadphase still has bounds which contain the end of every cache that didn't go stale...
+        broadphase->query(bounds, results);
+        for (size_t other : results)
+        {
+            if (!caches[other].broadphaseStale) tryContact(caches[other]);
+        }
+
+        // ...but stale caches have to be checked directly
+        for (size_t other : step.staleCaches)
+        {
+            tryContact(caches[other]);
+        }
+
+        // Static sensors don't detect other static colliders
+        if (sensor.isStatic) return;
+
+        staticTree.query(bounds, results);
+        for (size_t other : results)
+        {
+            tryContact(staticCaches[other]);
+        }
+    };
+
+    for (size_t index : step.sensorCaches)
+    {
+        findContacts(caches[index]);
+    }
+
+    for (size_t index : staticSensors)
+    {
+        findContacts(staticCaches[index]);
+    }
+
+    auto byId = [](const SensorContact& a, const SensorContact& b)
+    {
+        if (a.first->getID() != b.first->getID()) return a.first->getID() < b.first->getID();
+        return a.second->getID() < b.second->getID();
+    };
+    std::sort(newSensorContacts.begin(), newSensorContacts.end(), byId);
+
+    // Both lists are sorted, so merging them finds which contacts started, continued and ended
+    size_t i = 0;
+    size_t j = 0;
+    while (i < sensorContacts.size() || j < newSensorContacts.size())
+    {
+        if (j == newSensorContacts.size() ||
+            (i < sensorContacts.size() && byId(sensorContacts[i], newSensorContacts[j])))
+        {
+            sensorEvents.push_back(SensorEvent(SensorEvent::EXIT, sensorContacts[i].first, sensorContacts[i].second));
+            ++i;
+        }
+        else if (i == sensorContacts.size() || byId(newSensorContacts[j], sensorContacts[i]))
+        {
+            sensorEvents.push_back(SensorEvent(SensorEvent::ENTER, newSensorContacts[j].first, newSensorContacts[j].second));
+            ++j;
+        }
+        else
+        {
+            sensorEvents.push_back(SensorEvent(SensorEvent::STAY, newSensorContacts[j].first, newSensorContacts[j].second));
+            ++i;
+            ++j;
+        }
+    }
+
+    std::swap(sensorContacts, newSensorContacts);
+}
+
+bool CollisionSystem::shapesOverlap(const ColliderShape& a, sf::Vector2f positionA,
+                                    const ColliderShape& b, sf::Vector2f positionB) const
+{
+    bool overlaps = false;
+
+    forEachPart(a, positionA, [&](ShapeType typeA, size_t indexA, sf::Vector2f partA, size_t)
+    {
+        forEachPart(b, positionB, [&](ShapeType typeB, size_t indexB, sf::Vector2f partB, size_t)
+        {
+            if (overlaps) return;
+
+            sf::Vector2f closest;
+            if (typeA == CIRCLE)
+            {
+                overlaps = getPartDistance(typeB, indexB, partB, partA, closest) <= circleShapes[indexA].radius;
+            }
+            else if (typeB == CIRCLE)
+            {
+                overlaps = getPartDistance(typeA, indexA, partA, partB, closest) <= circleShapes[indexB].radius;
+            }
+            else if (typeA == LINE && typeB == LINE)
+            {
+                auto& vecA = lineShapes[indexA].vec;
+                auto& vecB = lineShapes[indexB].vec;
+                overlaps = findLineIntersection(partA, partA + vecA, partB, partB + vecB).strictIntersection;
+            }
+        });
+    });
+
+    return overlaps;
+}
+
+size_t CollisionSystem::buildIslands()
+{
+    // Union-find over moving caches followed by static caches
+    auto& parents = step.islandParents;
+    parents.resize(step.caches.size() + staticCaches.size());
+    std::iota(parents.begin(), parents.end(), 0);
+
+    auto findRoot = [&parents](size_t node)
+    {
+        while (parents[node] != node)
+        {
+            parents[node] = parents[parents[node]];
+            node = parents[node];
+        }
+
+        return node;
+    };
+
+    auto getNode = [this](const EntityCache* cache)
+    {
+        return cache->isStatic ? step.caches.size() + cache->index : cache->index;
+    };
+
+    auto join = [&](size_t nodeA, size_t nodeB)
+    {
+        size_t rootA = findRoot(nodeA);
+        size_t rootB = findRoot(nodeB);
+
+        // Always keep the lowest node as the root so island order is deterministic
+        if (rootA < rootB) parents[rootB] = rootA;
+        else if (rootB < rootA) parents[rootA] = rootB;
+    };
+
+    for (auto& pc : step.collisions)
+    {
+        // Nothing about a static collider changes unless it has callbacks to call
+        if (pc.second->isStatic && !shapes[pc.second->shape].collider->hasCallbacks()) continue;
+
+        join(getNode(pc.first), getNode(pc.second));
+    }
+
+    // A parented collider's position is read through its ancestors, which their own collisions may move,
+    // so it has to be solved in the same island as any of them which have colliders
+    for (auto& cache : step.caches)
+    {
+        if (step.cachePairs[cache.index].empty()) continue;
+
+        Entity::ID parent = shapes[cache.shape].transform->getParent();
+        while (parent != Entity::invalidID)
+        {
+            Entity* ancestor = world->getEntity(parent);
+            parent = ancestor->getComponent<TransformComponent>()->getParent();
+
+            auto it = shapeIndices.find(ancestor);
+            if (it == shapeIndices.end()) continue;
+
+            size_t ancestorCache = step.shapeCaches[it->second];
+            if (ancestorCache != noCache)
+            {
+                join(cache.index, ancestorCache);
+                continue;
+            }
+
+            // Static ancestors are rare, and only change if they have callbacks
+            if (!shapes[it->second].collider->hasCallbacks()) continue;
+
+            auto found = std::find_if(staticCaches.begin(), staticCaches.end(),
+                                      [ancestor](const EntityCache& other) { return other.entity == ancestor; });
+            if (found != staticCaches.end()) join(cache.index, getNode(&*found));
+        }
+    }
+
+    auto& islands = step.islands;
+    size_t count = 0;
+    step.rootIslands.assign(parents.size(), noIsland);
+    step.cacheIslands.assign(step.caches.size(), noIsland);
+
+    for (size_t i = 0; i < step.caches.size(); ++i)
+    {
+        if (step.cachePairs[i].empty()) continue;
+
+        size_t root = findRoot(i);
+        if (step.rootIslands[root] == noIsland)
+        {
+            // Reuse islands from earlier steps where possible
+            step.rootIslands[root] = count;
+            if (count < islands.size()) islands[count].reset(count);
+            else islands.push_back(Island(count));
+
+            ++count;
+        }
+
+        step.cacheIslands[i] = step.rootIslands[root];
+    }
+
+    // The first cache in each pair is always a moving one
+    for (size_t i = 0; i < step.collisions.size(); ++i)
+    {
+        islands[step.cacheIslands[step.collisions[i].first->index]].pairs.push_back(i);
+    }
+
+    return count;
+}
+
+void CollisionSystem::schedule(Island& island, size_t pair)
+{
+    auto& pc = step.collisions[pair];
+    if (pc.round == island.round) return;
+
+    pc.round = island.round;
+    ++pc.version;
+    island.scheduled.push_back(pair);
+}
+
+void CollisionSystem::solveScheduled(Island& island)
+{
+    sf::Clock clock;
+    findCollisionTimes(step.collisions, island.scheduled, island.narrowphase);
+    island.narrowphaseTime += clock.getElapsedTime();
+    island.narrowphaseTests += island.narrowphase.circleCircle.size() + island.narrowphase.circleLine.size();
+
+    for (size_t pair : island.scheduled)
+    {
+        auto& pc = step.collisions[pair];
+        if (pc.time >= island.startTime)
+        {
+            island.impacts.push(ImpactEvent(pc.time, pair, pc.version));
+        }
+    }
+
+    island.scheduled.clear();
+}
+
+void CollisionSystem::solveIsland(Island& island, bool contained)
+{
+    auto& changes = island.changes;
+    changes.clear();
+
+    while (!island.impacts.empty())
+    {
+        if (isOverBudget(island))
+        {
+            clampRemaining(island);
+            island.overflowed = true;
+            return;
+        }
+
+        ++island.resolvedRounds;
+        float time = island.impacts.top().time;
+
+        // Carry out every impact at this time before dealing with changes.
+        // This avoids ignoring collisions if they have the same time.
+        while (!island.impacts.empty() && island.impacts.top().time == time)
+        {
+            ImpactEvent impact = island.impacts.top();
+            island.impacts.pop();
+
+            // The pair has been recalculated since this was queued
+            auto& pc = step.collisions[impact.pair];
+            if (impact.version != pc.version) continue;
+
+            resolve(pc, island);
+        }
+
+        if (changes.empty()) continue;
+
+        // Each Entity only needs handling once. Going in slot order rather than address order keeps
+        // the new pairs, and so the order of simultaneous impacts, the same from run to run.
+        std::sort(changes.begin(), changes.end(), [](const Entity* a, const Entity* b)
+        {
+            return Entity::indexOf(a->getID()) < Entity::indexOf(b->getID());
+        });
+        changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+
+        if (!contained)
+        {
+            applyChanges(island, changes, time);
+            changes.clear();
+            continue;
+        }
+
+        // Changing an Entity from another island would race with that island, and adding or removing
+        // compound parts would reshuffle the circles and lines that every island reads
+        bool escaped = false;
+        for (auto& entity : changes)
+        {
+            size_t index = findCache(entity);
+            if (index == noCache) continue;
+
+            if (step.cacheIslands[index] != island.index || hasPartsChanged(step.caches[index].shape))
+            {
+                escaped = true;
+            }
+        }
+
+        // While changed entities stay inside their initial bounds, they can only hit things they were already paired with
+        if (!escaped)
+        {
+            for (auto& entity : changes)
+            {
+                size_t index = findCache(entity);
+                if (index == noCache) continue;
+
+                auto& cache = step.caches[index];
+                unsigned filterVersion = cache.filterVersion;
+                refreshShape(cache.shape);
+                cache.update(this, time);
+                wake(cache);
+
+                // A new layer or mask may allow pairs with things outside of the island
+                if (!step.initialBounds[index].contains(cache.bounds) || cache.filterVersion != filterVersion)
+                {
+                    escaped = true;
+                }
+            }
+        }
+
+        if (escaped)
+        {
+            // Leave the changes for the remaining island to apply
+            island.escaped = true;
+            island.startTime = time;
+            return;
+        }
+
+        island.startTime = time;
+        ++island.round;
+
+        for (auto& entity : changes)
+        {
+            size_t index = findCache(entity);
+            if (index == noCache) continue;
+
+            for (size_t pair : step.cachePairs[index])
+            {
+                schedule(island, pair);
+            }
+        }
+        solveScheduled(island);
+        changes.clear();
+    }
+}
+
+bool CollisionSystem::isOverBudget(const Island& island) const
+{
+    if (maxRounds > 0 && island.resolvedRounds >= maxRounds) return true;
+
+    return timeBudget > sf::Time::Zero && stepClock.getElapsedTime() >= timeBudget;
+}
+
+void CollisionSystem::clampRemaining(Island& island)
+{
+    auto clamp = [this, &island](EntityCache& cache)
+    {
+        auto transform = shapes[cache.shape].transform;
+        if (transform->getParent() != Entity::invalidID || transform->isPositionDiscrete()) return;
+
+        // The transform's current position is where the cache starts
+        float alpha = cache.startTime >= 1.f ? 1.f : (island.startTime - cache.startTime) / (1.f - cache.startTime);
+        transform->setNextLocalPosition(transform->getInterpLocalPosition(ECSE::clamp(0.f, 1.f, alpha)));
+
+        // The new end is on the old path, so the cache stays inside its bounds
+        cache.update(this, cache.startTime);
+    };
+
+    while (!island.impacts.empty())
+    {
+        ImpactEvent impact = island.impacts.top();
+        island.impacts.pop();
+
+        auto& pc = step.collisions[impact.pair];
+        if (impact.version != pc.version) continue;
+
+        clamp(*pc.first);
+        if (!pc.second->isStatic) clamp(*pc.second);
+    }
+}
+
+void CollisionSystem::applyChanges(Island& island, const ColliderComponent::ChangeList& changes, float time)
+{
+    island.startTime = time;
+    ++island.round;
+
+    std::vector<size_t> changedCaches;
+    for (auto& entity : changes)
+    {
+        // Static colliders never move, so there's nothing to update
+        size_t index = findCache(entity);
+        if (index == noCache) continue;
+
+        auto& cache = step.caches[index];
+        refreshShape(cache.shape);
+        cache.update(this, time);
+        wake(cache);
+        changedCaches.push_back(index);
+    }
+
+    // Changed entities may now sweep through entities they didn't overlap before
+    addPotentialCollisions(changedCaches);
+
+    for (size_t index : changedCaches)
+    {
+        for (size_t pair : step.cachePairs[index])
+        {
+            schedule(island, pair);
+        }
+    }
+    solveScheduled(island);
+}
+
+void CollisionSystem::setWorkerCount(size_t count)
+{
+    if (count == getWorkerCount()) return;
+
+    workerPool = count > 0 ? std::make_unique<WorkerPool>(count) : nullptr;
+}
+
+// http://www.gamasutra.com/view/feature/131424/pool_hall_lessons_fast_accurate_.php?page=2
+void CollisionSystem::findCollisionTimes(std::vector<PotentialCollision>& collisions, const std::vector<size_t>& pairs,
+                                         NarrowphaseBatch& batch) const
+{
+    batch.circleCircle.clear();
+    batch.circleLine.clear();
+    batch.circleCirclePairs.clear();
+    batch.circleLinePairs.clear();
+
+    for (size_t pair : pairs)
+    {
+        auto& pc = collisions[pair];
+
+        auto& shapeA = shapes[pc.first->shape];
+        auto& shapeB = shapes[pc.second->shape];
+
+        // Disabled, or the layers changed so that they can't collide any more
+        if (!shapeA.enabled || !shapeB.enabled || !canCollide(*pc.first, *pc.second))
+        {
+            pc.time = -1.f;
+            continue;
+        }
+
+        // If one of the start times is non-zero, then we're dealing with a collision in a smaller
+        // time scale, e.g. if maxStartTime is 0.3, then the collision can only take place in the
+        // last 0.7 units of our frame
+        float startTimeA = pc.first->startTime;
+        float startTimeB = pc.second->startTime;
+
+        float maxStartTime = std::max(startTimeA, startTimeB);
+        float timeScale = 1.f - maxStartTime;
+
+        sf::Vector2f startA = pc.first->start;
+        sf::Vector2f endA = pc.first->end;
+        sf::Vector2f startB = pc.second->start;
+        sf::Vector2f endB = pc.second->end;
+
+        // If one start time is greater than the other, then we also need to interpolate the position
+        // of the "earlier" object so they both start at the same time.
+        if (startTimeA < startTimeB)
+        {
+            float lerpAmt = timeScale == 0.f ? 1.f : (startTimeB - startTimeA) / timeScale;
+            lerpAmt = ECSE::clamp(0.f, 1.f, lerpAmt);
+            startA = ECSE::lerp(startA, endA, lerpAmt);
+        }
+        else if (startTimeB < startTimeA)
+        {
+            float lerpAmt = timeScale == 0.f ? 1.f : (startTimeA - startTimeB) / timeScale;
+            lerpAmt = ECSE::clamp(0.f, 1.f, lerpAmt);
+            startB = ECSE::lerp(startB, endB, lerpAmt);
+        }
+
+        // Work with relative motion rather than absoute motion to reduce the
+        // problem to one moving collider and one stationary
+        sf::Vector2f moveVec = (endA - startA) - (endB - startB);
+
+        // No collision detection for this pair of types (yet?) unless an entry is added.
+        // Compound colliders add an entry for each pair of parts.
+        pc.time = -1.f;
+        forEachPart(shapeA, startA, [&](ShapeType typeA, size_t indexA, sf::Vector2f partA, size_t firstPart)
+        {
+            forEachPart(shapeB, startB, [&](ShapeType typeB, size_t indexB, sf::Vector2f partB, size_t secondPart)
+            {
+                batchFunctions[typeA][typeB](*this, batch, BatchEntry{ pair, firstPart, secondPart, false },
+                                             indexA, partA, indexB, partB, moveVec);
+            });
+        });
+    }
+
+    solveBatch(batch.circleCircle);
+    solveBatch(batch.circleLine);
+
+    auto finish = [&collisions](const BatchEntry& entry, float time, sf::Vector2f normal)
+    {
+        auto& pc = collisions[entry.pair];
+        if (time < 0.f) return;
+
+        // If we started this collision check at a later time than 0.f, then we need to modify
+        // the time value accordingly. Note that if maxStartTime is 0.f, nothing happens here.
+        float maxStartTime = std::max(pc.first->startTime, pc.second->startTime);
+        if (time > 0.f)
+            time = maxStartTime + (1.f - maxStartTime) * time;
+
+        // Only the earliest of a compound collider's entries counts
+        if (pc.time >= 0.f && pc.time <= time) return;
+
+        pc.time = time;
+        pc.normal = entry.inverted ? -normal : normal;
+        pc.firstPart = entry.firstPart;
+        pc.secondPart = entry.secondPart;
+    };
+
+    for (size_t i = 0; i < batch.circleCirclePairs.size(); ++i)
+    {
+        finish(batch.circleCirclePairs[i], batch.circleCircle.time[i], batch.circleCircle.getNormal(i));
+    }
+
+    for (size_t i = 0; i < batch.circleLinePairs.size(); ++i)
+    {
+        finish(batch.circleLinePairs[i], batch.circleLine.time[i], batch.circleLine.getNormal(i));
+    }
+}
+
+bool CollisionSystem::batchNone(const CollisionSystem&, NarrowphaseBatch&, const BatchEntry&,
+                                size_t, sf::Vector2f, size_t, sf::Vector2f, sf::Vector2f)
+{
+    return false;
+}
+
+bool CollisionSystem::batchCircleCircle(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                        size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec)
+{
+    float radiusA = cs.circleShapes[a].radius;
+    float radiusB = cs.circleShapes[b].radius;
+
+    batch.circleCircle.add(startA, radiusA, startB, radiusB, moveVec);
+    batch.circleCirclePairs.push_back(entry);
+    return true;
+}
+
+bool CollisionSystem::batchCircleLine(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                      size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec)
+{
+    float radiusA = cs.circleShapes[a].radius;
+    auto& vecB = cs.lineShapes[b].vec;
+
+    batch.circleLine.add(startA, radiusA, startB, startB + vecB, moveVec);
+    batch.circleLinePairs.push_back(entry);
+    return true;
+}
+
+bool CollisionSystem::batchLineCircle(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                      size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec)
+{
+    // The circle-line batch needs the circle to be the moving one, so its normal points the wrong way
+    BatchEntry inverted = entry;
+    inverted.inverted = true;
+
+    return batchCircleLine(cs, batch, inverted, b, startB, a, startA, -moveVec);
+}
+
+void CollisionSystem::Island::reset(size_t newIndex)
+{
+    index = newIndex;
+    pairs.clear();
+    impacts.clear();
+    startTime = 0.f;
+    round = 1;
+    resolvedRounds = 0;
+    overflowed = false;
+    escaped = false;
+    changes.clear();
+    contacts.clear();
+    scheduled.clear();
+    narrowphaseTests = 0;
+    narrowphaseTime = sf::Time::Zero;
+}
+
+void CollisionSystem::resolve(const PotentialCollision& pc, Island& island) const
+{
+    auto colliderA = shapes[pc.first->shape].collider;
+    auto colliderB = shapes[pc.second->shape].collider;
+
+    // May have been disabled in the middle of collision detection
+    if (!colliderA->enabled || !colliderB->enabled) return;
+
+    // Build the collision
+    float firstTime = pc.first->startTime;
+    float secondTime = pc.second->startTime;
+
+    auto collision = Collision(pc.first->entity,
+                               pc.second->entity,
+                               pc.time,
+
+                               // We need to scale the time here to account for changing positions in mid-frame
+                               transformSystem->getInterpGlobalPosition(
+                                   *pc.first->entity,
+                                   firstTime == 1.f ? 1.f : (pc.time - firstTime) / (1 - firstTime)
+                               ),
+                               transformSystem->getInterpGlobalPosition(
+                                   *pc.second->entity,
+                                   secondTime == 1.f ? 1.f : (pc.time - secondTime) / (1 - secondTime)
+                               ),
+
+                               pc.normal);
+    collision.part = pc.firstPart;
+    collision.otherPart = pc.secondPart;
+
+    // Built-in responses come first, so callbacks can still override them
+    applyResponse(*pc.first, pc.time, pc.normal, island);
+    applyResponse(*pc.second, pc.time, -pc.normal, island);
+
+    island.contacts.push_back(collision);
+    size_t firstChange = island.changes.size();
+    colliderA->callCallbacks(collision, island.changes);
+
+    // Invert it for the second entity so it sees colliderB as itself
+    collision.invert();
+
+    colliderB->callCallbacks(collision, island.changes);
+
+    // Other islands may be hitting the same static collider right now
+    for (size_t i = firstChange; i < island.changes.size(); ++i)
+    {
+        assert(!isSharedStatic(island.changes[i]));
+    }
+}
+
+void CollisionSystem::applyResponse(const EntityCache& cache, float time, sf::Vector2f normal, Island& island) const
+{
+    auto& shape = shapes[cache.shape];
+    if (shape.response == ColliderComponent::NONE || cache.isStatic) return;
+
+    auto transform = shape.transform;
+    if (transform->getParent() != Entity::invalidID || transform->isPositionDiscrete()) return;
+
+    // The transform's current position is where the cache starts
+    float alpha = cache.startTime >= 1.f ? 1.f : (time - cache.startTime) / (1.f - cache.startTime);
+    sf::Vector2f position = transform->getInterpLocalPosition(ECSE::clamp(0.f, 1.f, alpha));
+    sf::Vector2f remaining = transform->getNextLocalPosition() - position;
+
+    // Only motion into the other collider is changed
+    float into = getDotProduct(remaining, normal);
+    if (shape.response == ColliderComponent::STOP)
+    {
+        remaining = sf::Vector2f();
+    }
+    else if (into > 0.f)
+    {
+        float scale = shape.response == ColliderComponent::REFLECT ? 1.f + shape.restitution : 1.f;
+        remaining -= normal * (into * scale);
+    }
+
+    transform->setLocalPosition(position, false);
+    transform->setNextLocalPosition(position + remaining);
+    island.changes.push_back(cache.entity);
+}
+
+CollisionSystem::EntityCache::EntityCache(size_t shape, CollisionSystem* cs, bool isStatic)
+    : entity(cs->shapes[shape].entity), shape(shape), isStatic(isStatic)
+{
+    update(cs, 0.f);
+}
+
+void CollisionSystem::EntityCache::update(CollisionSystem* cs, float time)
+{
+    auto& colliderShape = cs->shapes[shape];
+
+    startTime = time;
+    start = cs->getShapePosition(colliderShape, false);
+    filterVersion = colliderShape.filterVersion;
+
+    if (isStatic || colliderShape.transform->isPositionDiscrete())
+    {
+        end = start;
+    }
+    else
+    {
+        end = cs->getShapePosition(colliderShape, true);
+    }
+
+    updateBounds(cs);
+}
+
+void CollisionSystem::EntityCache::updateBounds(const CollisionSystem* cs)
+{
+    auto& colliderShape = cs->shapes[shape];
+
+    bounds = AABB();
+    bounds.include(start);
+    bounds.include(end);
+
+    // Every part of a compound collider shares the same bounds
+    auto includePart = [&](ShapeType type, size_t typeIndex, sf::Vector2f position, size_t)
+    {
+        cs->includePart(bounds, type, typeIndex, position);
+    };
+    cs->forEachPart(colliderShape, start, includePart);
+    cs->forEachPart(colliderShape, end, includePart);
+
+    bounds.pad(broadphaseMargin);
+}
+
+std::ostream& operator<<(std::ostream& stream, const CollisionSystem::Statistics& statistics)
+{
+    auto ms = [](sf::Time time)
+    {
+        return time.asMicroseconds() / 1000.f;
+    };
+
+    return stream << statistics.colliders << " colliders, "
+                  << statistics.pairs << " pairs, "
+                  << statistics.narrowphaseTests << " tests, "
+                  << statistics.hits << " hits, "
+                  << statistics.islands << " islands, "
+                  << statistics.rounds << " rounds, "
+                  << statistics.cacheRebuilds << " cache rebuilds, "
+                  << statistics.staticTreeRebuilds << " static rebuilds; "
+                  << "refresh " << ms(statistics.refreshTime) << "ms, "
+                  << "broadphase " << ms(statistics.broadphaseTime) << "ms, "
+                  << "islands " << ms(statistics.islandTime) << "ms, "
+                  << "solve " << ms(statistics.solveTime) << "ms, "
+                  << "narrowphase " << ms(statistics.narrowphaseTime) << "ms, "
+                  << "sensors " << ms(statistics.sensorTime) << "ms, "
+                  << "total " << ms(statistics.totalTime) << "ms";
 }
 
 }
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <functional>
+#include <unordered_map>
 #include "SetSystem.h"
 #include "TransformSystem.h"
 #include "ColliderComponent.h"
+#include "Broadphase.h"
+#include "StaticBVH.h"
+#include "WorkerPool.h"
+#include "BatchCollisionMath.h"
 
 namespace ECSE
 {
@@ -14,8 +23,9 @@ class CollisionSystem :
 public:
     //! Construct the CollisionSystem.
     explicit CollisionSystem(World* world)
-        : SetSystem(world)
+        : SetSystem(world), broadphase(std::make_unique<SortAndSweepBroadphase>())
     {
+        require<TransformComponent, ColliderComponent>();
     }
 
     //! Called on an advance step.
@@ -49,6 +59,320 @@ public:
     */
     sf::Vector2f getNextColliderPosition(const Entity& e) const;
 
+    //! Set the Broadphase used to find potential collisions.
+    /*!
+    * Defaults to a SortAndSweepBroadphase.
+    * \param newBroadphase The new Broadphase.
+    */
+    void setBroadphase(std::unique_ptr<Broadphase> newBroadphase);
+
+    //! Get the Broadphase used to find potential collisions.
+    /*!
+    * \return A reference to the Broadphase.
+    */
+    inline Broadphase& getBroadphase() const
+    {
+        return *broadphase;
+    }
+
+    //! Get the number of potential collision pairs checked in the last advance step.
+    /*!
+    * \return The number of pairs whose swept bounds overlapped.
+    */
+    inline size_t getPairCount() const
+    {
+        return pairCount;
+    }
+
+    //! Get the time spent finding potential collision pairs in the last advance step.
+    /*!
+    * \return The time spent in the Broadphase.
+    */
+    inline sf::Time getBroadphaseTime() const
+    {
+        return broadphaseTime;
+    }
+
+    //! Get the number of static colliders in the System.
+    /*!
+    * \return The number of Entities whose ColliderComponent is static.
+    */
+    inline size_t getStaticCount() const
+    {
+        return staticEntities.size();
+    }
+
+    //! Set the number of worker threads used to solve collision islands.
+    /*!
+    * Entities are grouped into islands whose swept bounds don't interact, and each island is solved
+    * separately. With workers, callbacks from different islands may run at the same time, so they
+    * must only modify the Entities in the Collision they're given, and must not create or destroy
+    * Entities. Results don't depend on the number of workers.
+    *
+    * A static collider with no callbacks of its own can be hit from many islands at once, so callbacks
+    * must not modify its Entity either, whatever the number of workers.
+    *
+    * \param count The number of extra threads, or 0 to solve everything on the calling thread.
+    */
+    void setWorkerCount(size_t count);
+
+    //! Get the number of worker threads used to solve collision islands.
+    /*!
+    * \return The number of extra threads.
+    */
+    inline size_t getWorkerCount() const
+    {
+        return workerPool ? workerPool->getWorkerCount() : 0;
+    }
+
+    //! Get the number of collision islands in the last advance step.
+    /*!
+    * \return The number of groups of Entities which were solved separately.
+    */
+    inline size_t getIslandCount() const
+    {
+        return islandCount;
+    }
+
+    //! Set the number of steps a collider must stay still for before it falls asleep.
+    /*!
+    * Sleeping colliders aren't re-cached each step and are only checked against awake colliders whose
+    * swept bounds reach them, so two sleeping colliders which overlap won't collide. A collider wakes
+    * up as soon as its transform is written to, its collider is changed, or it's changed by a collision.
+    * Colliders with parents never fall asleep.
+    *
+    * \param steps The number of steps, or 0 to disable sleeping.
+    */
+    inline void setSleepSteps(unsigned steps)
+    {
+        sleepSteps = steps;
+    }
+
+    //! Get the number of steps a collider must stay still for before it falls asleep.
+    /*!
+    * \return The number of steps, or 0 if sleeping is disabled.
+    */
+    inline unsigned getSleepSteps() const
+    {
+        return sleepSteps;
+    }
+
+    //! Check whether an Entity's collider is asleep.
+    /*!
+    * \param e The Entity.
+    * \return Whether the Entity is in the System and its collider is asleep.
+    */
+    bool isAsleep(const Entity& e) const;
+
+    //! Get the number of sleeping colliders in the last advance step.
+    /*!
+    * \return The number of moving colliders which were asleep.
+    */
+    inline size_t getSleepingCount() const
+    {
+        return sleepingCount;
+    }
+
+    //! Set the maximum number of times an island may resolve impacts in one step.
+    /*!
+    * Each distinct impact time counts as one round. Islands which escaped are finished together, carrying
+    * on from the most rounds any of them had used. When an island runs out, everything which was still going
+    * to hit something is stopped where it was at the last time that was fully resolved, and the overflow is
+    * counted.
+    *
+    * \param rounds The number of rounds, or 0 for no limit.
+    */
+    inline void setMaxRounds(unsigned rounds)
+    {
+        maxRounds = rounds;
+    }
+
+    //! Get the maximum number of times an island may resolve impacts in one step.
+    /*!
+    * \return The number of rounds, or 0 for no limit.
+    */
+    inline unsigned getMaxRounds() const
+    {
+        return maxRounds;
+    }
+
+    //! Set how long collision detection may take in one step.
+    /*!
+    * This is checked before each round, and any island still solving when it runs out overflows as if it
+    * had run out of rounds. Unlike the round limit, results then depend on how fast the machine is.
+    *
+    * \param budget The time limit, or sf::Time::Zero for no limit.
+    */
+    inline void setTimeBudget(sf::Time budget)
+    {
+        timeBudget = budget;
+    }
+
+    //! Get how long collision detection may take in one step.
+    /*!
+    * \return The time limit, or sf::Time::Zero for no limit.
+    */
+    inline sf::Time getTimeBudget() const
+    {
+        return timeBudget;
+    }
+
+    //! Get the number of islands which ran out of budget in the last advance step.
+    /*!
+    * \return The number of overflows.
+    */
+    inline size_t getOverflowCount() const
+    {
+        return overflowCount;
+    }
+
+    //! Get the number of islands which have run out of budget since the System was created.
+    /*!
+    * \return The total number of overflows.
+    */
+    inline size_t getTotalOverflowCount() const
+    {
+        return totalOverflowCount;
+    }
+
+    //! Counters and timings from an advance step.
+    struct Statistics
+    {
+        size_t colliders = 0;               //!< The number of colliders in the System.
+        size_t pairs = 0;                   //!< The number of pairs whose swept bounds overlapped.
+        size_t narrowphaseTests = 0;        //!< The number of times a pair of shapes had its collision time found.
+        size_t hits = 0;                    //!< The number of collisions which were resolved.
+        size_t islands = 0;                 //!< The number of collision islands.
+        size_t rounds = 0;                  //!< The number of impact times resolved, summed over every island.
+        size_t cacheRebuilds = 0;           //!< The number of times the moving caches were rebuilt.
+        size_t staticTreeRebuilds = 0;      //!< The number of times the static collider hierarchy was rebuilt.
+        sf::Time refreshTime;               //!< Time spent copying components and updating caches.
+        sf::Time broadphaseTime;            //!< Time spent finding pairs, including pairs found while solving.
+        sf::Time islandTime;                //!< Time spent grouping pairs into islands.
+        sf::Time solveTime;                 //!< Time spent finding collision times and resolving collisions.
+        sf::Time narrowphaseTime;           //!< Time spent finding collision times, summed over every island.
+        sf::Time sensorTime;                //!< Time spent finding sensor overlaps.
+        sf::Time totalTime;                 //!< Time spent in the whole step.
+    };
+
+    //! Get the counters and timings from the last advance step.
+    /*!
+    * With worker threads, islands are solved at the same time, so narrowphaseTime may be more than solveTime.
+    * \return The statistics.
+    */
+    inline const Statistics& getStatistics() const
+    {
+        return statistics;
+    }
+
+    //! Set whether the statistics are logged after each advance step.
+    /*!
+    * \param log Whether to log them.
+    */
+    inline void setLogStatistics(bool log)
+    {
+        logStatistics = log;
+    }
+
+    //! Get whether the statistics are logged after each advance step.
+    /*!
+    * \return Whether they're logged.
+    */
+    inline bool getLogStatistics() const
+    {
+        return logStatistics;
+    }
+
+    //! Get every collision which was resolved in the last advance step.
+    /*!
+    * Each Collision is from the point of view of the first Entity in the pair. Collisions are grouped by
+    * island, in the order they were resolved within each, and collisions of islands which escaped come last.
+    * This is filled whether or not the colliders have callbacks, so Systems can handle collisions in bulk
+    * after the step instead.
+    * \return The collisions.
+    */
+    inline const std::vector<Collision>& getContacts() const
+    {
+        return contacts;
+    }
+
+    //! Get the sensor events from the last advance step.
+    /*!
+    * Events are ordered by the ids of the sensor and then the other Entity. If either Entity is removed
+    * from the System, no EXIT event is reported for it.
+    * \return The events.
+    */
+    inline const std::vector<SensorEvent>& getSensorEvents() const
+    {
+        return sensorEvents;
+    }
+
+    //! The result of a raycast or nearest query.
+    struct QueryHit
+    {
+        Entity* entity = nullptr;           //!< The Entity whose collider was found.
+        float distance = 0.f;               //!< The distance from the start of the ray, or from the query point.
+        sf::Vector2f position;              //!< Where the ray hit the collider, or the closest point on the collider.
+        sf::Vector2f normal;                //!< The normal of the collider's surface at position.
+        size_t part = Collision::noPart;    //!< The part of a CompoundColliderComponent which was found, or Collision::noPart.
+    };
+
+    //! Find the first collider hit by a line segment.
+    /*!
+    * Spatial queries find colliders at their current positions, using the same hierarchies as collision
+    * detection. Positions are read on the first query after each advance step, so they don't see transforms
+    * which are set after that until the next step. Queries aren't thread-safe, so they mustn't be made from
+    * collision callbacks while there are worker threads.
+    *
+    * \param start The start of the segment.
+    * \param end The end of the segment.
+    * \param hit Filled with the closest hit, if there was one.
+    * \param mask Only colliders on one of these layers are hit.
+    * \return Whether anything was hit.
+    */
+    bool raycast(sf::Vector2f start, sf::Vector2f end, QueryHit& hit, std::uint32_t mask = ~0u);
+
+    //! Find every collider which overlaps a circle.
+    /*!
+    * \param center The center of the circle.
+    * \param radius The radius of the circle.
+    * \param results Filled with each overlapping Entity. Existing contents are cleared.
+    * \param mask Only colliders on one of these layers are found.
+    */
+    void overlapCircle(sf::Vector2f center, float radius, std::vector<Entity*>& results, std::uint32_t mask = ~0u);
+
+    //! Find every collider which overlaps an AABB.
+    /*!
+    * \param bounds The AABB.
+    * \param results Filled with each overlapping Entity. Existing contents are cleared.
+    * \param mask Only colliders on one of these layers are found.
+    */
+    void overlapAABB(const AABB& bounds, std::vector<Entity*>& results, std::uint32_t mask = ~0u);
+
+    //! Find the collider closest to a point.
+    /*!
+    * \param point The point.
+    * \param hit Filled with the closest collider, if there was one. The distance is 0 if the point is inside it.
+    * \param mask Only colliders on one of these layers are found.
+    * \param maxDistance Colliders at least this far away are ignored.
+    * \return Whether anything was found.
+    */
+    bool nearest(sf::Vector2f point, QueryHit& hit, std::uint32_t mask = ~0u,
+                 float maxDistance = std::numeric_limits<float>::max());
+
+protected:
+    //! Add an Entity to the System, tracking it separately if its collider is static.
+    /*!
+    * \param e The Entity to add.
+    */
+    void internalAddEntity(Entity& e) override;
+
+    //! Remove an Entity from the System.
+    /*!
+    * \param e The Entity to remove.
+    */
+    void internalRemoveEntity(Entity& e) override;
+
 private:
     ///////
     // Data
@@ -56,39 +380,190 @@ private:
     //! The TransformSystem of this world.
     TransformSystem* transformSystem;
 
+    //! Finds pairs of Entities whose swept bounds overlap.
+    std::unique_ptr<Broadphase> broadphase;
+
+    //! The number of potential collision pairs checked in the last advance step.
+    size_t pairCount = 0;
+
+    //! The time spent finding potential collision pairs in the last advance step.
+    sf::Time broadphaseTime;
+
+    //! Solves islands in parallel, or null to solve them on the calling thread.
+    std::unique_ptr<WorkerPool> workerPool;
+
+    //! The number of collision islands in the last advance step.
+    size_t islandCount = 0;
+
+    //! The number of steps a collider must stay still for before it falls asleep, or 0 to disable sleeping.
+    unsigned sleepSteps = 60;
+
+    //! The number of sleeping colliders in the last advance step.
+    size_t sleepingCount = 0;
+
+    //! The maximum number of rounds an island may resolve in one step, or 0 for no limit.
+    unsigned maxRounds = 1024;
+
+    //! How long collision detection may take in one step, or zero for no limit.
+    sf::Time timeBudget;
+
+    //! Measures how long the current step has taken, for timeBudget.
+    sf::Clock stepClock;
+
+    //! The number of islands which ran out of budget in the last advance step.
+    size_t overflowCount = 0;
+
+    //! The number of islands which have run out of budget since the System was created.
+    size_t totalOverflowCount = 0;
+
+    //! Counters and timings from the last advance step.
+    Statistics statistics;
+
+    //! Whether statistics are logged after each advance step.
+    bool logStatistics = false;
+
+    //! Entities with static colliders, in the order they were added so the static tree is built deterministically.
+    EntitySet staticEntities;
+
+    //! Every collision which was resolved in the last advance step.
+    std::vector<Collision> contacts;
+
+    //! The sensor events from the last advance step.
+    std::vector<SensorEvent> sensorEvents;
+
+    //! A sensor and an Entity it overlaps.
+    typedef std::pair<Entity*, Entity*> SensorContact;
+
+    //! Every sensor overlap in the last advance step, ordered by the ids of the sensor and then the other Entity.
+    std::vector<SensorContact> sensorContacts;
+
+    //! The sensor overlaps found in the current step, which replace sensorContacts.
+    std::vector<SensorContact> newSensorContacts;
+
+    //! Whether static colliders have been added or removed since staticTree was built.
+    bool staticTreeDirty = false;
+
+    //! Whether any Entities have been added or removed since the caches were built.
+    bool cachesDirty = true;
+
+    //! The kinds of collider shape the solver knows about.
+    enum ShapeType
+    {
+        NONE,
+        CIRCLE,
+        LINE,
+        COMPOUND,
+        SHAPE_TYPE_COUNT
+    };
+
+    //! The parameters of a circle collider, or a circle in a compound collider.
+    struct CircleShape
+    {
+        float radius;       //!< The radius of the circle.
+        size_t shape;       //!< The index of the ColliderShape which owns this.
+        size_t part;        //!< The index of this in the owner's CompoundShape, or Collision::noPart.
+    };
+
+    //! The parameters of a line collider, or a line in a compound collider.
+    struct LineShape
+    {
+        sf::Vector2f vec;   //!< The vector from the start to the end of the line.
+        size_t shape;       //!< The index of the ColliderShape which owns this.
+        size_t part;        //!< The index of this in the owner's CompoundShape, or Collision::noPart.
+    };
+
+    //! A circle or line in a compound collider.
+    struct CompoundPart
+    {
+        ShapeType type;         //!< The type of the part, which is never COMPOUND.
+        size_t typeIndex;       //!< The index of the part's parameters in circleShapes or lineShapes.
+        sf::Vector2f offset;    //!< The part's offset from the collider's position.
+    };
+
+    //! The parameters of a compound collider.
+    struct CompoundShape
+    {
+        std::vector<CompoundPart> parts;    //!< The parts, in the same order as the component's.
+        size_t shape;                       //!< The index of the ColliderShape which owns this.
+    };
+
+    //! A copy of everything the solver needs from an Entity's components.
+    /*!
+    * These are kept for as long as the Entity is in the System, so the solver never has to look up or
+    * dereference components while checking pairs. Shape parameters live in circleShapes or lineShapes.
+    */
+    struct ColliderShape
+    {
+        Entity* entity;                     //!< The Entity.
+        ColliderComponent* collider;        //!< The Entity's ColliderComponent.
+        TransformComponent* transform;      //!< The Entity's TransformComponent.
+        ShapeType type;                     //!< The type of the collider.
+        size_t typeIndex;                   //!< The index of the shape parameters in circleShapes, lineShapes or compoundShapes.
+        sf::Vector2f offset;                //!< The collider's offset.
+        bool enabled;                       //!< Whether the collider is enabled.
+        bool isStatic;                      //!< Whether the collider never moves.
+        bool isSensor;                      //!< Whether the collider only reports overlaps.
+        ColliderComponent::Response response;   //!< The collider's built-in response.
+        float restitution;                  //!< The collider's restitution.
+        std::uint32_t layer;                //!< The collider's layer.
+        std::uint32_t mask;                 //!< The collider's mask.
+        unsigned filterVersion;             //!< The collider's filter version.
+        unsigned transformVersion;          //!< The transform's write version when the shape was last refreshed.
+        unsigned stillSteps;                //!< The number of steps the Entity has stayed still for, up to sleepSteps.
+    };
+
+    //! The copied data of every Entity in the System.
+    std::vector<ColliderShape> shapes;
+
+    //! Map from Entity to its index in shapes.
+    std::unordered_map<Entity*, size_t> shapeIndices;
+
+    //! Parameters of every circle collider.
+    std::vector<CircleShape> circleShapes;
+
+    //! Parameters of every line collider.
+    std::vector<LineShape> lineShapes;
+
+    //! Parameters of every compound collider.
+    std::vector<CompoundShape> compoundShapes;
+
     //! Stores data about an Entity so we can avoid using iterators (which slow down debug mode a lot).
     struct EntityCache
     {
         Entity* entity;                     //!< The Entity.
-        ColliderComponent* collider;        //!< The Entity's ColliderComponent.
+        size_t shape;                       //!< The index of the Entity's ColliderShape.
         sf::Vector2f start;                 //!< The Entity's start position.
         sf::Vector2f end;                   //!< The Entity's next position.
         float startTime;                    //!< The inter-step time at which the Entity is at its start position.
-
-        enum ColliderType
-        {
-            NONE,
-            CIRCLE,
-            LINE
-        } type; //!< The type of the Entity's collider.
+        AABB bounds;                        //!< The bounds swept by the collider between start and end.
+        bool broadphaseStale = false;       //!< Whether bounds have changed since they were given to the Broadphase.
+        bool isStatic;                      //!< Whether the collider never moves.
+        bool asleep = false;                //!< Whether the collider is asleep, in which case the cache isn't updated.
+        unsigned filterVersion = 0;         //!< The collider's filter version when the cache was last updated.
+        size_t index = 0;                   //!< The index of this cache among either the moving or static caches.
 
         //! Construct an EntityCache.
         /*!
-        * \param entity The Entity whose data we want to cache.
+        * \param shape The index of the ColliderShape of the Entity whose data we want to cache.
         * \param cs The CollisionSystem which holds the Entity.
+        * \param isStatic Whether the Entity never moves, in which case its end position is its start position.
         */
-        EntityCache(Entity* entity, CollisionSystem* cs);
+        EntityCache(size_t shape, CollisionSystem* cs, bool isStatic = false);
 
         //! Update the cache when the Entity is changed.
         /*!
+        * The Entity's ColliderShape should be refreshed first.
         * \param cs The CollisionSystem which holds the Entity.
         * \param time The inter-frame time at which the update happened.
         */
         void update(CollisionSystem* cs, float time);
 
     private:
-        //! Get the collider pointer and type.
-        void setupCollider();
+        //! Update the swept bounds from the start and end positions.
+        /*!
+        * \param cs The CollisionSystem which holds the Entity.
+        */
+        void updateBounds(const CollisionSystem* cs);
     };
 
     //! Stores data about a collision which may happen and the time at which it will happen.
@@ -98,6 +573,10 @@ private:
         EntityCache* second;    //!< The second Entity in the collision.
         float time;             //!< The time at which the collision will occur, or <0 if it won't occur.
         sf::Vector2f normal;    //!< The normal of the collision direction.
+        size_t firstPart = Collision::noPart;   //!< The part of the first Entity's compound collider which will collide.
+        size_t secondPart = Collision::noPart;  //!< The part of the second Entity's compound collider which will collide.
+        unsigned version = 0;   //!< Incremented whenever the time is recalculated, so stale ImpactEvents can be skipped.
+        unsigned round = 0;     //!< The solver round in which the time was last calculated.
 
         //! Construct a PotentialCollision.
         PotentialCollision(EntityCache* first, EntityCache* second, float time = -1.f,
@@ -105,18 +584,151 @@ private:
             : first(first), second(second), time(time), normal(normal)
         {
         }
+    };
 
-        //! Compare based on collision time.
+    //! A pending impact between a pair of Entities.
+    struct ImpactEvent
+    {
+        float time;         //!< The time at which the impact will happen.
+        size_t pair;        //!< The index of the PotentialCollision.
+        unsigned version;   //!< The version of the PotentialCollision when this was scheduled.
+
+        //! Construct an ImpactEvent.
+        ImpactEvent(float time, size_t pair, unsigned version)
+            : time(time), pair(pair), version(version)
+        {
+        }
+
+        //! Compare based on impact time, using the pair index as a tie-breaker.
         /*!
-        * \param other The other PotentialCollision.
-        * \return Whether this will happen first.
+        * \param other The other ImpactEvent.
+        * \return Whether this will happen after other.
         */
-        bool operator<(const PotentialCollision& other) const
+        bool operator>(const ImpactEvent& other) const
+        {
+            if (time != other.time) return time > other.time;
+            return pair > other.pair;
+        }
+    };
+
+    //! A min-heap of ImpactEvents, with the earliest on top.
+    struct ImpactQueue : std::priority_queue<ImpactEvent, std::vector<ImpactEvent>, std::greater<ImpactEvent>>
+    {
+        //! Remove every ImpactEvent, keeping the storage.
+        void clear()
         {
-            return time < other.time;
+            c.clear();
         }
     };
 
+    //! Which PotentialCollision an entry in a narrowphase batch belongs to.
+    struct BatchEntry
+    {
+        size_t pair;            //!< The index of the PotentialCollision.
+        size_t firstPart;       //!< The part of the first Entity's collider, or Collision::noPart.
+        size_t secondPart;      //!< The part of the second Entity's collider, or Collision::noPart.
+        bool inverted;          //!< Whether the shapes were swapped for the batch, so the normal must be flipped.
+    };
+
+    //! Reusable buffers for finding the times of many PotentialCollisions at once, grouped by shape type.
+    /*!
+    * Pairs involving compound colliders have an entry for each pair of parts, and take the earliest time.
+    */
+    struct NarrowphaseBatch
+    {
+        CircleCircleBatch circleCircle;             //!< Circle-circle collisions.
+        CircleLineBatch circleLine;                 //!< Circle-line and line-circle collisions.
+        std::vector<BatchEntry> circleCirclePairs;  //!< The pair of each entry in circleCircle.
+        std::vector<BatchEntry> circleLinePairs;    //!< The pair of each entry in circleLine.
+    };
+
+    //! A group of Entities whose collisions can't affect anything outside the group.
+    struct Island
+    {
+        size_t index;                           //!< The index of the island.
+        std::vector<size_t> pairs;              //!< The pairs in the island.
+        ImpactQueue impacts;                    //!< Impacts which haven't been resolved yet.
+        float startTime = 0.f;                  //!< Collisions before this time have either been dealt with or are invalid.
+        unsigned round = 1;                     //!< Incremented whenever something changes.
+        unsigned resolvedRounds = 0;            //!< The number of impact times which have been resolved.
+        bool overflowed = false;                //!< Whether the island ran out of budget.
+        bool escaped = false;                   //!< Whether an Entity left the island's bounds.
+        ColliderComponent::ChangeList changes;  //!< Entities changed by the impacts being resolved, or which caused the escape.
+        std::vector<Collision> contacts;        //!< Collisions resolved in the island.
+        std::vector<size_t> scheduled;          //!< Pairs waiting for their times to be recalculated.
+        NarrowphaseBatch narrowphase;           //!< Buffers for recalculating times.
+        size_t narrowphaseTests = 0;            //!< The number of shape pairs which had their times found.
+        sf::Time narrowphaseTime;               //!< Time spent finding collision times.
+
+        //! Construct an Island.
+        explicit Island(size_t index)
+            : index(index)
+        {
+        }
+
+        //! Empty the island so it can be reused, keeping the storage.
+        /*!
+        * \param newIndex The new index of the island.
+        */
+        void reset(size_t newIndex);
+    };
+
+    //! Everything the solver works with during an advance step.
+    /*!
+    * This is kept between steps so that its storage can be reused. Only caches and shapeCaches carry
+    * anything over; the rest is rebuilt each step.
+    */
+    struct StepData
+    {
+        std::vector<EntityCache> caches;                    //!< Caches for moving colliders, in the same order as their shapes.
+        std::vector<size_t> shapeCaches;                    //!< The index in caches of each ColliderShape, or noCache if it's static.
+        std::vector<size_t> sensorCaches;                   //!< The indices of caches which are sensors.
+        std::vector<AABB> initialBounds;                    //!< The bounds of each cache at the start of the step.
+        std::vector<size_t> cacheIslands;                   //!< The island of each cache, or noIsland.
+        std::vector<PotentialCollision> collisions;         //!< Every pair whose swept bounds overlap.
+        std::vector<std::vector<size_t>> cachePairs;        //!< The pairs each cache is part of.
+        std::vector<size_t> staleCaches;                    //!< Caches whose bounds the Broadphase no longer matches.
+        std::vector<Broadphase::Pair> broadphasePairs;      //!< Pairs found by the Broadphase.
+        std::vector<size_t> queryResults;                   //!< Results of Broadphase and StaticBVH queries.
+        std::vector<size_t> islandParents;                  //!< The union-find parent of each cache, used to build islands.
+        std::vector<size_t> rootIslands;                    //!< The island of each union-find root.
+        std::vector<Island> islands;                        //!< The islands. Only the first islandCount are in use.
+        Island remaining = Island(0);                       //!< Islands which escaped, finished together.
+    };
+
+    //! Data for the current step, kept so its storage can be reused.
+    StepData step;
+
+    //! The island of a cache which doesn't collide with anything.
+    static const size_t noIsland = static_cast<size_t>(-1);
+
+    //! The cache index of a ColliderShape which doesn't have a moving cache.
+    static const size_t noCache = static_cast<size_t>(-1);
+
+    //! Caches for Entities with static colliders, in the same order as they were given to staticTree.
+    std::vector<EntityCache> staticCaches;
+
+    //! Hierarchy over the bounds of staticCaches.
+    StaticBVH staticTree;
+
+    //! The indices of staticCaches which are sensors.
+    std::vector<size_t> staticSensors;
+
+    //! Hierarchy over the current bounds of step.caches, used for spatial queries.
+    StaticBVH queryTree;
+
+    //! The bounds of each of step.caches when queryTree was built.
+    std::vector<AABB> queryBounds;
+
+    //! The position of each of step.caches when queryTree was built.
+    std::vector<sf::Vector2f> queryPositions;
+
+    //! Whether anything may have moved since queryTree was built.
+    bool queryTreeDirty = true;
+
+    //! Results of StaticBVH queries made by spatial queries.
+    std::vector<size_t> queryIndices;
+
     //! Hash functor for PotentialCollisions.
     struct PCHash
     {
@@ -132,30 +744,419 @@ private:
     };
 
 
+    //! Adds a pair to the right narrowphase batch for its shape types.
+    /*!
+    * \param cs The CollisionSystem.
+    * \param batch The batch to add to.
+    * \param entry The pair and parts which the entry belongs to.
+    * \param a The index of the first shape's parameters in circleShapes or lineShapes.
+    * \param startA The position of the first shape.
+    * \param b The index of the second shape's parameters in circleShapes or lineShapes.
+    * \param startB The position of the second shape.
+    * \param moveVec The motion of the first Entity relative to the second.
+    * \return Whether the pair was added, which is false if the types can't collide.
+    */
+    typedef bool (*BatchFunction)(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                  size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec);
+
+    //! The BatchFunction for each pair of shape types.
+    /*!
+    * Compound colliders are split into their parts first, so they never use this directly.
+    */
+    static const BatchFunction batchFunctions[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT];
+
+
     ////////////
     // Functions
 
-    //! Update all potential collision pairs.
+    //! Add a ColliderShape for a newly added Entity.
     /*!
-    * \param caches The cached Entity data.
-    * \return A vector of PotentialCollisions with times of -1.f to indicate that they haven't been solved.
+    * \param e The Entity.
     */
-    std::vector<PotentialCollision> getPotentialCollisions(std::vector<EntityCache>& caches) const;
+    void addShape(Entity& e);
 
-    //! Find the time and normal for a potential collision between two entities.
+    //! Remove the ColliderShape of an Entity, moving the last one into its place.
     /*!
-    * Sets the time and normal values of the PotentialCollision to the found value if there was
-    * a collision, or <0 if no collision.
-    * \param pc The PotentialCollision.
+    * \param index The index of the ColliderShape.
+    */
+    void removeShape(size_t index);
+
+    //! Remove the parameters of a circle or line, moving the last one into its place.
+    /*!
+    * \param type The type of the shape, which must be CIRCLE or LINE.
+    * \param typeIndex The index of the parameters in circleShapes or lineShapes.
+    */
+    void removeTyped(ShapeType type, size_t typeIndex);
+
+    //! Count how many of a compound collider's parts still have the same type as in its component.
+    /*!
+    * \param index The index of the ColliderShape, which must be a compound.
+    * \return The number of leading parts which can be updated in place.
+    */
+    size_t countKeptParts(size_t index) const;
+
+    //! Check whether refreshing a ColliderShape would add or remove circles or lines.
+    /*!
+    * \param index The index of the ColliderShape.
+    * \return Whether it's a compound whose parts were added, removed or changed type.
+    */
+    bool hasPartsChanged(size_t index) const;
+
+    //! Make the parts of a compound collider's ColliderShape match its component.
+    /*!
+    * \param index The index of the ColliderShape.
+    * \return Whether anything changed.
+    */
+    bool refreshCompound(size_t index);
+
+    //! Call a function for each circle or line which makes up a collider.
+    /*!
+    * Colliders other than compound ones are a single part.
+    * \param shape The ColliderShape.
+    * \param position The position of the collider.
+    * \param fn Called with the type, index in circleShapes or lineShapes, position and part index (or
+    *           Collision::noPart) of each part.
+    */
+    template <typename Function>
+    void forEachPart(const ColliderShape& shape, sf::Vector2f position, Function fn) const
+    {
+        if (shape.type != COMPOUND)
+        {
+            fn(shape.type, shape.typeIndex, position, Collision::noPart);
+            return;
+        }
+
+        auto& parts = compoundShapes[shape.typeIndex].parts;
+        for (size_t i = 0; i < parts.size(); ++i)
+        {
+            fn(parts[i].type, parts[i].typeIndex, position + parts[i].offset, i);
+        }
+    }
+
+    //! Copy the current state of an Entity's components into its ColliderShape.
+    /*!
+    * If anything but the transform changed, the Entity is woken up.
+    * \param index The index of the ColliderShape.
+    */
+    void refreshShape(size_t index);
+
+    //! Count how long an Entity has stayed still for, so that it can fall asleep.
+    /*!
+    * The ColliderShape should be refreshed first.
+    * \param index The index of the ColliderShape.
+    */
+    void updateSleep(size_t index);
+
+    //! Check whether a ColliderShape has stayed still for long enough to be asleep.
+    /*!
+    * \param shape The ColliderShape.
+    * \return Whether it's asleep.
+    */
+    inline bool isShapeAsleep(const ColliderShape& shape) const
+    {
+        return sleepSteps > 0 && !shape.isStatic && shape.stillSteps >= sleepSteps;
+    }
+
+    //! Wake up a cached Entity which was changed during the step.
+    /*!
+    * \param cache The cache.
+    */
+    inline void wake(EntityCache& cache)
+    {
+        cache.asleep = false;
+        shapes[cache.shape].stillSteps = 0;
+    }
+
+    //! Get the global position of a collider from its ColliderShape.
+    /*!
+    * \param shape The ColliderShape.
+    * \param next Whether to get the next position rather than the current one.
+    * \return The position.
+    */
+    sf::Vector2f getShapePosition(const ColliderShape& shape, bool next) const;
+
+    //! BatchFunction for pairs which can't collide.
+    static bool batchNone(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                          size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec);
+
+    //! BatchFunction for circle-circle pairs.
+    static bool batchCircleCircle(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                  size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec);
+
+    //! BatchFunction for circle-line pairs.
+    static bool batchCircleLine(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec);
+
+    //! BatchFunction for line-circle pairs.
+    static bool batchLineCircle(const CollisionSystem& cs, NarrowphaseBatch& batch, const BatchEntry& entry,
+                                size_t a, sf::Vector2f startA, size_t b, sf::Vector2f startB, sf::Vector2f moveVec);
+
+    //! Rebuild staticCaches and staticTree from staticEntities.
+    void rebuildStaticTree();
+
+    //! Make sure the caches, staticTree and queryTree are up to date before a spatial query.
+    void prepareQueries();
+
+    //! Get the bounds of a collider at some position.
+    /*!
+    * \param shape The ColliderShape.
+    * \param position The position of the collider.
+    * \return The bounds.
+    */
+    AABB getShapeBounds(const ColliderShape& shape, sf::Vector2f position) const;
+
+    //! Grow an AABB to include a circle or line.
+    /*!
+    * \param bounds The AABB.
+    * \param type The type of the part.
+    * \param typeIndex The index of the part's parameters in circleShapes or lineShapes.
+    * \param position The position of the part.
+    */
+    void includePart(AABB& bounds, ShapeType type, size_t typeIndex, sf::Vector2f position) const;
+
+    //! Check whether a collider should be found by a spatial query.
+    /*!
+    * \param shape The ColliderShape.
+    * \param mask The layers the query looks for.
+    * \return Whether the collider is enabled and on one of the layers.
+    */
+    inline bool matchesQuery(const ColliderShape& shape, std::uint32_t mask) const
+    {
+        return shape.enabled && (shape.layer & mask) != 0;
+    }
+
+    //! Call a function for each collider which may be found by a spatial query in some bounds.
+    /*!
+    * \param bounds The bounds of the query.
+    * \param fn Called with the ColliderShape and position of each collider whose bounds overlap.
+    */
+    template <typename Function>
+    void forEachQueryCandidate(const AABB& bounds, Function fn)
+    {
+        staticTree.query(bounds, queryIndices);
+        for (size_t index : queryIndices)
+        {
+            fn(shapes[staticCaches[index].shape], staticCaches[index].start);
+        }
+
+        queryTree.query(bounds, queryIndices);
+        for (size_t index : queryIndices)
+        {
+            fn(shapes[step.caches[index].shape], queryPositions[index]);
+        }
+    }
+
+    //! Find where a line segment first hits a collider.
+    /*!
+    * \param shape The ColliderShape.
+    * \param position The position of the collider.
+    * \param start The start of the segment.
+    * \param end The end of the segment.
+    * \param normal Set to the normal of the collider's surface at the hit point.
+    * \param part Set to the part which was hit.
+    * \return The distance along the segment in range [0, 1], or <0 if the segment misses.
+    */
+    float raycastShape(const ColliderShape& shape, sf::Vector2f position, sf::Vector2f start, sf::Vector2f end,
+                       sf::Vector2f& normal, size_t& part) const;
+
+    //! Find the closest point on a collider to another point.
+    /*!
+    * \param shape The ColliderShape.
+    * \param position The position of the collider.
+    * \param point The point.
+    * \param closest Set to the closest point on the collider, or point if it's inside.
+    * \param part Set to the part which closest is on.
+    * \return The distance from point to closest.
+    */
+    float getShapeDistance(const ColliderShape& shape, sf::Vector2f position, sf::Vector2f point,
+                           sf::Vector2f& closest, size_t& part) const;
+
+    //! Find the closest point on a circle or line to another point.
+    /*!
+    * \param type The type of the part.
+    * \param typeIndex The index of the part's parameters in circleShapes or lineShapes.
+    * \param position The position of the part.
+    * \param point The point.
+    * \param closest Set to the closest point on the part, or point if it's inside.
+    * \return The distance from point to closest.
+    */
+    float getPartDistance(ShapeType type, size_t typeIndex, sf::Vector2f position, sf::Vector2f point,
+                          sf::Vector2f& closest) const;
+
+    //! Rebuild the moving caches after Entities were added or removed.
+    void rebuildCaches();
+
+    //! Get the index of an Entity's moving cache.
+    /*!
+    * \param entity The Entity.
+    * \return The index in step.caches, or noCache if the Entity isn't in the System or is static.
+    */
+    size_t findCache(Entity* entity) const;
+
+    //! Check whether an Entity has a static collider with no callbacks, which several islands may share.
+    /*!
+    * \param entity The Entity.
+    * \return Whether it's shared.
+    */
+    bool isSharedStatic(Entity* entity) const;
+
+    //! Find all potential collision pairs for the step.
+    /*!
+    * Only pairs whose swept bounds overlap are added to step.collisions, and pairs of two static
+    * colliders are never added.
+    * Their times are -1.f to indicate that they haven't been solved.
+    */
+    void getPotentialCollisions();
+
+    //! Add potential collisions for Entities whose swept bounds changed partway through the step.
+    /*!
+    * \param changed The indices of the caches which changed.
     */
-    void findCollisionTime(PotentialCollision& pc) const;
+    void addPotentialCollisions(const std::vector<size_t>& changed);
+
+    //! Add a pair to step.collisions and record which caches it belongs to, unless it's already there.
+    /*!
+    * \param a The first cache, which must be moving.
+    * \param b The second cache.
+    */
+    void addPair(EntityCache& a, EntityCache& b);
+
+    //! Check whether the layers and masks of two cached Entities allow them to collide.
+    /*!
+    * Sensors never collide with anything.
+    * \param a The first cache.
+    * \param b The second cache.
+    * \return Whether a pair should be made for them.
+    */
+    inline bool canCollide(const EntityCache& a, const EntityCache& b) const
+    {
+        auto& shapeA = shapes[a.shape];
+        auto& shapeB = shapes[b.shape];
+        return !shapeA.isSensor && !shapeB.isSensor && canOverlap(shapeA, shapeB);
+    }
+
+    //! Check whether the layers and masks of two colliders allow them to touch.
+    /*!
+    * \param a The first ColliderShape.
+    * \param b The second ColliderShape.
+    * \return Whether each is on a layer in the other's mask.
+    */
+    inline bool canOverlap(const ColliderShape& a, const ColliderShape& b) const
+    {
+        return (a.layer & b.mask) != 0 && (b.layer & a.mask) != 0;
+    }
+
+    //! Find what each sensor overlaps at the end of the step and turn the differences into SensorEvents.
+    /*!
+    * This must happen after the solver, since the end positions of the caches are used.
+    */
+    void updateSensors();
+
+    //! Check whether two colliders overlap.
+    /*!
+    * \param a The first ColliderShape.
+    * \param positionA The position of the first collider.
+    * \param b The second ColliderShape.
+    * \param positionB The position of the second collider.
+    * \return Whether they touch or overlap.
+    */
+    bool shapesOverlap(const ColliderShape& a, sf::Vector2f positionA, const ColliderShape& b, sf::Vector2f positionB) const;
+
+    //! Group caches into islands which can't affect each other.
+    /*!
+    * Static colliders with callbacks join the islands of everything they touch, but static colliders
+    * without callbacks are never modified, so they can be shared.
+    * The islands in step.islands are ordered by their lowest cache index.
+    * \return The number of islands.
+    */
+    size_t buildIslands();
+
+    //! Mark a pair to have its time recalculated, superseding any impact already queued for it.
+    /*!
+    * Does nothing if the pair was already scheduled in the island's current round.
+    * \param island The island which owns the pair.
+    * \param pair The index of the pair.
+    */
+    void schedule(Island& island, size_t pair);
+
+    //! Recalculate the time of each scheduled pair and queue up the ones which will collide.
+    /*!
+    * \param island The island whose scheduled pairs should be solved.
+    */
+    void solveScheduled(Island& island);
+
+    //! Resolve impacts in time order until there are none left.
+    /*!
+    * If contained is true, only the island's own data is touched, so separate islands may be solved
+    * at the same time. In that case, solving stops when an Entity leaves the island (or a callback
+    * changes an Entity from another island, or changes which parts a compound collider has), and the
+    * island is marked as escaped.
+    *
+    * \param island The island to solve.
+    * \param contained Whether to stop rather than look for pairs outside of the island.
+    */
+    void solveIsland(Island& island, bool contained);
+
+    //! Check whether an island has used up its budget for the step.
+    /*!
+    * \param island The island.
+    * \return Whether it should stop resolving impacts.
+    */
+    bool isOverBudget(const Island& island) const;
+
+    //! Stop everything with an impact still queued in an island at the last time which was fully resolved.
+    /*!
+    * Each Entity's next position is set to where it was at island.startTime, and its impacts are dropped.
+    * Parented and discretely moving Entities are left alone.
+    * \param island The island which ran out of budget.
+    */
+    void clampRemaining(Island& island);
+
+    //! Update changed caches and reschedule their pairs, looking for new pairs anywhere in the world.
+    /*!
+    * \param island The island to schedule new impacts in.
+    * \param changes The changed Entities.
+    * \param time The time at which they changed.
+    */
+    void applyChanges(Island& island, const ColliderComponent::ChangeList& changes, float time);
+
+    //! Find the time and normal for a set of potential collisions.
+    /*!
+    * Sets the time and normal values of each PotentialCollision to the found value if there was
+    * a collision, or <0 if no collision. Pairs are grouped by shape type and solved in batches.
+    * Only the copied ColliderShapes are read, never the Entities or their components.
+    * \param collisions Every PotentialCollision.
+    * \param pairs The indices of the PotentialCollisions to solve.
+    * \param batch Buffers to use while solving.
+    */
+    void findCollisionTimes(std::vector<PotentialCollision>& collisions, const std::vector<size_t>& pairs,
+                            NarrowphaseBatch& batch) const;
 
     //! Notify colliders of a collision that actually happened.
     /*!
+    * Built-in responses are applied first. The collision is added to the island's contacts, and any Entities
+    * which were changed are appended to its changes.
     * \param pc The PotentialCollision.
-    * \return Any Entities which were changed by the collision.
+    * \param island The island which owns the pair.
     */
-    ColliderComponent::ChangeSet resolve(const PotentialCollision& pc) const;
+    void resolve(const PotentialCollision& pc, Island& island) const;
+
+    //! Apply a collider's built-in response to a collision.
+    /*!
+    * \param cache The cache of the Entity to move.
+    * \param time The time of the collision.
+    * \param normal The normal of the collision, from the Entity to the other one.
+    * \param island The island which owns the pair. The Entity is appended to its changes if it was moved.
+    */
+    void applyResponse(const EntityCache& cache, float time, sf::Vector2f normal, Island& island) const;
 };
 
+//! Write CollisionSystem statistics on one line.
+/*!
+* \param stream The stream to write to.
+* \param statistics The statistics.
+* \return The stream.
+*/
+std::ostream& operator<<(std::ostream& stream, const CollisionSystem::Statistics& statistics);
+
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace ECSE
 {
 
@@ -14,6 +16,8 @@ class Entity;
 class Component
 {
 public:
+    friend class ArchetypeStorage;
+    friend class ComponentManager;
     friend class Entity;
     virtual ~Component() {}
 
@@ -46,6 +50,9 @@ protected:
     * \param e The Entity to which this was attached.
     */
     virtual void attached(Entity* e) {};
+
+private:
+    size_t typeID = 0;  //!< The ID of this Component's concrete type, set when it's created.
 };
 
 }
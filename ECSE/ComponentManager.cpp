@@ -0,0 +1,118 @@
+#include "ComponentManager.h"
+#include <bitset>
+#include <sstream>
+
+namespace ECSE
+{
+
+void ComponentManager::storeComponents(Entity& entity)
+{
+    if (storageMode != ARCHETYPE_STORAGE || entity.components.empty()) return;
+
+    // Each concrete type only appears once, even if its Component was also attached as its base types
+    ComponentMask concrete;
+    for (Component* component : entity.components)
+    {
+        concrete.set(component->typeID);
+    }
+
+    size_t archetype = archetypes.findArchetype(concrete);
+    if (archetype == ArchetypeStorage::noArchetype)
+    {
+        std::vector<ArchetypeStorage::Column> columns;
+        for (size_t typeID = 0; typeID < maxComponentTypes; ++typeID)
+        {
+            if (!concrete.test(typeID)) continue;
+
+            const PoolBase& pool = *pools[typeID];
+            if (!pool.isRelocatable())
+            {
+                std::stringstream ss;
+                ss << "Component type " << typeID << " isn't move-constructible, so it can't be stored by archetype";
+
+                throw std::runtime_error(ss.str());
+            }
+
+            columns.push_back({ typeID, pool.getObjectSize(), pool.getObjectAlignment() });
+        }
+
+        archetype = archetypes.addArchetype(concrete, columns);
+    }
+
+    archetypes.insert(entity, archetype);
+
+    // Move each Component into its slot, and point every type it was attached as at the new address
+    std::bitset<maxComponentTypes> relocated;
+    for (size_t i = 0; i < entity.components.size(); ++i)
+    {
+        if (relocated.test(i)) continue;
+
+        Component* original = entity.components[i];
+        size_t typeID = original->typeID;
+        Component* moved = pools[typeID]->relocate(original, archetypes.getSlot(entity, typeID));
+
+        for (size_t j = i; j < entity.components.size(); ++j)
+        {
+            if (entity.components[j] != original) continue;
+
+            entity.components[j] = moved;
+            relocated.set(j);
+        }
+    }
+}
+
+void ComponentManager::queueDestroyComponents(Entity& entity)
+{
+    bool stored = entity.archetype != Entity::noArchetype;
+
+    entity.forEachDistinctComponent([&](Component* component)
+    {
+        if (stored)
+        {
+            // The memory belongs to the archetype's chunk, so just destroy the object
+            component->~Component();
+            return;
+        }
+
+        size_t typeID = component->typeID;
+        if (typeID >= destroyQueues.size())
+        {
+            destroyQueues.resize(typeID + 1);
+        }
+
+        destroyQueues[typeID].push_back(component);
+    });
+
+    if (stored)
+    {
+        archetypes.erase(entity);
+    }
+
+    entity.components.clear();
+    entity.mask.reset();
+}
+
+void ComponentManager::destroyQueuedComponents()
+{
+    for (size_t typeID = 0; typeID < destroyQueues.size(); ++typeID)
+    {
+        auto& queue = destroyQueues[typeID];
+        if (queue.empty()) continue;
+
+        pools[typeID]->destroyBatch(queue);
+        queue.clear();
+    }
+}
+
+void ComponentManager::destroyPooledComponent(Component* component)
+{
+    size_t typeID = component->typeID;
+    if (typeID >= pools.size() || !pools[typeID] || !pools[typeID]->isFrom(component))
+    {
+        throw std::runtime_error("Attempted to delete a component which was not created by this manager");
+    }
+
+    pools[typeID]->destroy(component);
+}
+
+}
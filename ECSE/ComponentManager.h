@@ -1,10 +1,12 @@
 #pragma once
 
-#include <map>
-#include <typeinfo>
+#include <memory>
 #include <type_traits>
-#include <boost/pool/object_pool.hpp>
+#include <vector>
+#include "ArchetypeStorage.h"
 #include "Component.h"
+#include "ComponentType.h"
+#include "Entity.h"
 #include "Pool.h"
 
 namespace ECSE {
@@ -17,6 +19,13 @@ namespace ECSE {
 class ComponentManager
 {
 public:
+    //! The ways Components can be stored once their Entity is registered.
+    enum StorageMode
+    {
+        POOL_STORAGE,       //!< Components stay in a pool for their type, and never move.
+        ARCHETYPE_STORAGE   //!< Components move into tables grouped by their Entity's Component types.
+    };
+
     //! Destroy the ComponentManager.
     virtual ~ComponentManager() {};
 
@@ -34,55 +43,121 @@ public:
     template <typename ComponentType>
     void destroyComponent(ComponentType* component);
 
+    //! Make room for a number of Components of each type to be created together.
+    /*!
+    * Components created once their pool's free memory runs out are then contiguous.
+    *
+    * \tparam ComponentTypes The Component types.
+    * \param count The number of Components of each type.
+    */
+    template <typename... ComponentTypes>
+    void reserveComponents(size_t count);
+
+    //! Set how Components are stored once their Entity is registered.
+    /*!
+    * With ARCHETYPE_STORAGE, registering an Entity moves its Components out of the pools into
+    * ArchetypeStorage. Pointers returned by attachComponent, and any pointer a Component's setup code
+    * kept to itself, are no longer valid afterward; use Entity::getComponent instead. Stored Components
+    * don't move again until they're destroyed. In debug builds, the memory they moved out of is poisoned.
+    *
+    * This only affects Entities registered after it's called.
+    *
+    * \param mode The storage mode.
+    */
+    inline void setStorageMode(StorageMode mode)
+    {
+        storageMode = mode;
+    }
+
+    //! Get how Components are stored once their Entity is registered.
+    /*!
+    * \return The storage mode.
+    */
+    inline StorageMode getStorageMode() const
+    {
+        return storageMode;
+    }
+
+    //! Get the storage which holds Components by archetype.
+    /*!
+    * This is only filled when the storage mode is ARCHETYPE_STORAGE.
+    *
+    * \return A reference to the ArchetypeStorage.
+    */
+    inline ArchetypeStorage& getArchetypeStorage()
+    {
+        return archetypes;
+    }
+
+protected:
+    //! Move an Entity's Components to their long-term storage.
+    /*!
+    * Should be called when the Entity is registered, before any Systems see it.
+    *
+    * \param entity The Entity.
+    */
+    void storeComponents(Entity& entity);
+
+    //! Destroy all of an Entity's Components.
+    /*!
+    * Components attached as several types are only destroyed once. Components stored by archetype are
+    * destroyed straight away, but pooled Components are queued by type and destroyed together by
+    * destroyQueuedComponents, which should be called once every Entity in the batch has been queued.
+    *
+    * \param entity The Entity.
+    */
+    void queueDestroyComponents(Entity& entity);
+
+    //! Destroy the Components queued by queueDestroyComponents.
+    /*!
+    * Each pool's Components are destroyed in one batch.
+    */
+    void destroyQueuedComponents();
+
 private:
-    //! Get the internal pool from a generic PoolBase.
+    //! Destroy a Component from one of the pools.
     /*!
-    * \param pool The generic pool.
-    * \return The internal Boost pool.
+    * \param component The Component.
     */
-    template <typename ComponentType>
-    static boost::object_pool<ComponentType>& getInternalPool(PoolBase& pool);
+    void destroyPooledComponent(Component* component);
 
-    //! Get the collection of Components of a given type.
+    //! Get the pool for a given type.
     /*!
     * \return A reference to the Component pool.
     */
     template <typename ComponentType>
-    PoolBase& getPool();
+    Pool<ComponentType>& getPool();
+
+    //! Pools of Components, indexed by Component type ID.
+    std::vector<std::unique_ptr<PoolBase>> pools;
+
+    //! Pooled Components waiting to be destroyed, indexed by Component type ID.
+    std::vector<std::vector<Component*>> destroyQueues;
 
-    //! Map from component type to pools of Components.
-    std::map<size_t, std::unique_ptr<PoolBase>> pools;
+    //! Components of registered Entities, if they're stored by archetype.
+    ArchetypeStorage archetypes;
 
-    //! Map from component pointer to pool.
-    std::map<Component*, PoolBase*> directory;
+    //! How Components are stored once their Entity is registered.
+    StorageMode storageMode = POOL_STORAGE;
 };
 
 //////////////////
 // Implementation
 
-template <typename ComponentType>
-boost::object_pool<ComponentType>& ComponentManager::getInternalPool(PoolBase& pool)
-{
-    typedef Pool<ComponentType> PType;
-
-    return static_cast<PType*>(&pool)->pool;
-}
-
 template <typename ComponentType>
 ComponentType* ComponentManager::createComponent()
 {
     // Get the pool of components for this type
     auto& pool = getPool<ComponentType>();
-    auto& typedPool = getInternalPool<ComponentType>(pool);
 
     // Attempt to allocate a new component
-    ComponentType* component = typedPool.construct();
+    ComponentType* component = pool.pool.construct();
     if (!component)
     {
         throw std::runtime_error("Out of memory!");
     }
 
-    directory[component] = &pool;
+    component->typeID = ComponentTypeRegistry::getID<ComponentType>();
 
     return component;
 }
@@ -90,40 +165,42 @@ ComponentType* ComponentManager::createComponent()
 template <typename ComponentType>
 void ComponentManager::destroyComponent(ComponentType* component)
 {
-    auto directoryIt = directory.find(component);
-    if (directoryIt == directory.end())
+    destroyPooledComponent(component);
+}
+
+template <typename... ComponentTypes>
+void ComponentManager::reserveComponents(size_t count)
+{
+    for (PoolBase* pool : { static_cast<PoolBase*>(&getPool<ComponentTypes>())... })
     {
-        throw std::runtime_error("Attempted to delete a component which was not created by this manager");
+        pool->reserve(count);
     }
-
-    // Get the pool of components for this type
-    auto pool = directoryIt->second;
-    auto& typedPool = getInternalPool<ComponentType>(*pool);
-
-    // Attempt to free the component
-    assert(typedPool.is_from(component));
-    typedPool.destroy(component);
 }
 
 template <typename ComponentType>
-PoolBase& ComponentManager::getPool()
+Pool<ComponentType>& ComponentManager::getPool()
 {
     static_assert(std::is_base_of<Component, ComponentType>::value,
                   "ComponentType must be a descendant of Component!");
 
     typedef Pool<ComponentType> PType;
 
-    size_t typeHash = typeid(ComponentType).hash_code();
+    size_t typeID = ComponentTypeRegistry::getID<ComponentType>();
+    if (typeID >= pools.size())
+    {
+        pools.resize(typeID + 1);
+    }
 
     // Get the base class pool pointer pool
-    PoolBase* pool = pools[typeHash].get();
+    PoolBase* pool = pools[typeID].get();
     if (!pool)
     {
-        pools[typeHash] = std::unique_ptr<PType>(new PType);
-        pool = pools[typeHash].get();
+        pools[typeID] = std::unique_ptr<PType>(new PType);
+        pool = pools[typeID].get();
     }
 
-    return *pool;
+    // We should be safe to do a static cast since the pool for each type ID is only made here.
+    return *static_cast<PType*>(pool);
 }
 
 }
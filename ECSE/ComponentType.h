@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include "Component.h"
+
+namespace ECSE
+{
+
+//! The maximum number of distinct Component types in a program.
+const size_t maxComponentTypes = 64;
+
+//! A set of Component types, with one bit for each type ID.
+typedef std::bitset<maxComponentTypes> ComponentMask;
+
+//! Assigns each Component type a small, dense integer ID.
+/*!
+* IDs are handed out the first time a type is asked for, so they start at 0 and there are no gaps.
+* This lets Entities find Components with a bit test and an array load instead of hashing type_info.
+* Note that IDs depend on the order in which types are first used, so they shouldn't be saved.
+*/
+class ComponentTypeRegistry
+{
+public:
+    //! Get the ID of a Component type.
+    /*!
+    * \tparam ComponentType The type. Must be a descendant of Component.
+    * \return The type's ID, which is less than maxComponentTypes.
+    */
+    template <typename ComponentType>
+    static size_t getID();
+
+    //! Get a mask with just this Component type's bit set.
+    /*!
+    * \tparam ComponentType The type. Must be a descendant of Component.
+    * \return The type's mask.
+    */
+    template <typename ComponentType>
+    static ComponentMask getMask();
+
+    //! Get the number of Component types which have been given an ID so far.
+    /*!
+    * \return The number of IDs handed out.
+    */
+    static size_t getTypeCount()
+    {
+        return counter().load();
+    }
+
+private:
+    //! Hand out the next ID.
+    /*!
+    * \param name The name of the type being registered, for the error message.
+    * \return The new ID.
+    */
+    static size_t nextID(const char* name)
+    {
+        size_t id = counter()++;
+
+        if (id >= maxComponentTypes)
+        {
+            std::stringstream ss;
+            ss << "Too many Component types (" << maxComponentTypes << " max) when registering \"" << name << "\"";
+
+            throw std::runtime_error(ss.str());
+        }
+
+        return id;
+    }
+
+    //! Get the number of IDs handed out so far.
+    /*!
+    * This is a function-local static so it's shared across translation units without needing a source file.
+    */
+    static std::atomic<size_t>& counter()
+    {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+};
+
+/////////////////
+// Implementation
+
+template <typename ComponentType>
+size_t ComponentTypeRegistry::getID()
+{
+    static_assert(std::is_base_of<Component, ComponentType>::value,
+                  "ComponentType must be a descendant of Component!");
+
+    // Initialization of function-local statics is thread-safe, so this is only assigned once
+    static const size_t id = nextID(typeid(ComponentType).name());
+    return id;
+}
+
+template <typename ComponentType>
+ComponentMask ComponentTypeRegistry::getMask()
+{
+    return ComponentMask().set(getID<ComponentType>());
+}
+
+}
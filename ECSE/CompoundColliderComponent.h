@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "ColliderComponent.h"
+
+namespace ECSE
+{
+
+//! A Component which stores several circles and lines which collide as one collider.
+/*!
+* This is cheaper than parenting an Entity for each shape, since the parts share one bounding volume
+* and are moved together. Collisions report which part was hit in Collision::part.
+*/
+class CompoundColliderComponent : public ColliderComponent
+{
+public:
+    //! This is an extension of ColliderComponent.
+    using ExtendsComponent = ColliderComponent;
+
+    //! A circle or line which makes up part of the collider.
+    struct Part
+    {
+        //! The kinds of part.
+        enum Type
+        {
+            CIRCLE,
+            LINE
+        };
+
+        Type type;              //!< The kind of part.
+        sf::Vector2f offset;    //!< The part's offset from the collider's position. Like vec, this doesn't rotate.
+        float radius;           //!< The circle's radius, if this is a circle.
+        sf::Vector2f vec;       //!< The vector from the start to the end of the line, if this is a line.
+    };
+
+    //! The parts of the collider, in the order Collision::part refers to them.
+    std::vector<Part> parts;
+
+    //! Add a circle to the collider.
+    /*!
+    * \param offset The circle's offset from the collider's position.
+    * \param radius The circle's radius.
+    * \return The index of the new part.
+    */
+    inline size_t addCircle(sf::Vector2f offset, float radius)
+    {
+        parts.push_back(Part{ Part::CIRCLE, offset, radius, sf::Vector2f() });
+        return parts.size() - 1;
+    }
+
+    //! Add a line to the collider.
+    /*!
+    * \param offset The offset of the line's start from the collider's position.
+    * \param vec The vector from the start to the end of the line.
+    * \return The index of the new part.
+    */
+    inline size_t addLine(sf::Vector2f offset, sf::Vector2f vec)
+    {
+        parts.push_back(Part{ Part::LINE, offset, 0.f, vec });
+        return parts.size() - 1;
+    }
+};
+
+}
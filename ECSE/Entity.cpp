@@ -4,6 +4,7 @@ namespace ECSE
 {
 
 const Entity::ID Entity::invalidID = 0;
+const size_t Entity::noArchetype;
 
 Entity::Entity()
 {
@@ -13,7 +14,7 @@ Entity::~Entity()
 {
 }
 
-const boost::unordered_map<size_t, Component*>& Entity::getComponents() const
+const std::vector<Component*>& Entity::getComponents() const
 {
     return components;
 }
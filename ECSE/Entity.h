@@ -1,8 +1,9 @@
 #pragma once
 
 #include "Component.h"
-#include <boost/unordered_map.hpp>
+#include "ComponentType.h"
 #include <cstdint>
+#include <vector>
 
 namespace ECSE
 {
@@ -15,13 +16,51 @@ namespace ECSE
 */
 class Entity
 {
+    friend class ArchetypeStorage;
+    friend class ComponentManager;
     friend class EntityManager;
     friend class World;
 
 public:
     //! The type used for Entity IDs.
+    /*!
+    * The low 32 bits are the index of the Entity's slot in the EntityManager, and the high 32 bits are
+    * the slot's generation, which changes every time an Entity in the slot is destroyed. This lets slots
+    * be reused while IDs of destroyed Entities stay invalid.
+    */
     typedef std::uint64_t ID;
 
+    //! Build an ID from a slot index and generation.
+    /*!
+    * \param index The slot index.
+    * \param generation The slot's generation.
+    * \return The ID.
+    */
+    static inline ID makeID(std::uint32_t index, std::uint32_t generation)
+    {
+        return (static_cast<ID>(generation) << 32) | index;
+    }
+
+    //! Get the slot index from an ID.
+    /*!
+    * \param id The ID.
+    * \return The slot index.
+    */
+    static inline std::uint32_t indexOf(ID id)
+    {
+        return static_cast<std::uint32_t>(id);
+    }
+
+    //! Get the slot generation from an ID.
+    /*!
+    * \param id The ID.
+    * \return The slot generation.
+    */
+    static inline std::uint32_t generationOf(ID id)
+    {
+        return static_cast<std::uint32_t>(id >> 32);
+    }
+
     //! Construct the Entity.
     Entity();
 
@@ -43,9 +82,26 @@ public:
 
     //! Get the Entity's Components.
     /*!
-    * \return A reference to the Entity's components, mapped by type hash code.
+    * A Component attached polymorphically appears once for each type it was attached as.
+    *
+    * \return A reference to the Entity's components, ordered by type ID.
     */
-    const boost::unordered_map<size_t, Component*>& getComponents() const;
+    const std::vector<Component*>& getComponents() const;
+
+    //! Get the set of Component types attached to this Entity.
+    /*!
+    * \return The mask of attached Component type IDs.
+    */
+    inline const ComponentMask& getComponentMask() const
+    {
+        return mask;
+    }
+
+    //! Check whether the Entity is waiting to be destroyed at the end of the World's update.
+    inline bool isDestroying() const
+    {
+        return destroying;
+    }
 
 
     // Data
@@ -61,10 +117,37 @@ private:
     template <typename ComponentType>
     void attachComponent(ComponentType* component);
 
-    // Use a boost unordered map because MSVC's STL unordered map is slower than molasses on a cold winter's day.
-    boost::unordered_map<size_t, Component*> components;    //!< Map from type hash code to a pointer to the Component.
-    ID id;                                                  //!< Unique identifier for this Entity.
-    bool registered = false;                                //!< Whether this has been registered in any Systems yet.
+    //! Call a function once for each distinct Component, even if it was attached as several types.
+    /*!
+    * The Components are all found before the function is first called, so it may destroy them.
+    *
+    * \param fn The function to call, as fn(Component*).
+    */
+    template <typename Function>
+    void forEachDistinctComponent(Function fn) const;
+
+    //! Get the index in components of a type which is attached.
+    /*!
+    * Components are kept in type ID order, so this is the number of attached types with a lower ID.
+    *
+    * \param typeID The type ID.
+    * \return The index into components.
+    */
+    inline size_t getIndex(size_t typeID) const
+    {
+        return (mask << (maxComponentTypes - typeID)).count();
+    }
+
+    std::vector<Component*> components; //!< Pointers to the Components, ordered by type ID.
+    ComponentMask mask;                 //!< Which Component type IDs are attached.
+    ID id = invalidID;                  //!< Unique identifier for this Entity.
+    bool registered = false;            //!< Whether this has been registered in any Systems yet.
+    bool destroying = false;            //!< Whether this is waiting to be destroyed at the end of the update.
+    size_t archetype = noArchetype;     //!< The archetype the Components are stored in, if they're stored by archetype.
+    size_t row = 0;                     //!< The Entity's row in its archetype.
+
+    //! Value of archetype when the Components are stored in pools.
+    static const size_t noArchetype = static_cast<size_t>(-1);
 };
 
 /////////////////
@@ -76,15 +159,36 @@ ComponentType* Entity::getComponent() const
     static_assert(std::is_base_of<Component, ComponentType>::value,
                   "ComponentType must be a descendant of Component!");
 
-    size_t hashCode = typeid(ComponentType).hash_code();
-    auto it = components.find(hashCode);
+    size_t typeID = ComponentTypeRegistry::getID<ComponentType>();
 
-    if (it == components.end())
+    if (!mask.test(typeID))
     {
         return nullptr;
     }
 
-    return static_cast<ComponentType*>(it->second);
+    return static_cast<ComponentType*>(components[getIndex(typeID)]);
+}
+
+template <typename Function>
+void Entity::forEachDistinctComponent(Function fn) const
+{
+    // Each concrete type can only be attached once, so its ID identifies the Component
+    Component* distinct[maxComponentTypes];
+    size_t count = 0;
+    ComponentMask seen;
+
+    for (Component* component : components)
+    {
+        if (seen.test(component->typeID)) continue;
+
+        seen.set(component->typeID);
+        distinct[count++] = component;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        fn(distinct[i]);
+    }
 }
 
 template <typename ComponentType>
@@ -93,10 +197,9 @@ void Entity::attachComponent(ComponentType* component)
     static_assert(std::is_base_of<Component, ComponentType>::value,
                   "ComponentType must be a descendant of Component!");
 
-    size_t hashCode = typeid(ComponentType).hash_code();
-    auto it = components.find(hashCode);
+    size_t typeID = ComponentTypeRegistry::getID<ComponentType>();
 
-    if (it != components.end())
+    if (mask.test(typeID))
     {
         std::stringstream ss;
         ss << "A Component of type \"" << typeid(ComponentType).name() << "\" is already attached to this Entity!";
@@ -104,7 +207,8 @@ void Entity::attachComponent(ComponentType* component)
         throw std::runtime_error(ss.str());
     }
 
-    components[hashCode] = component;
+    components.insert(components.begin() + getIndex(typeID), component);
+    mask.set(typeID);
 
     // Tell the Component it's been attached
     component->attached(this);
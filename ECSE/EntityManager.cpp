@@ -1,67 +1,82 @@
 #include "EntityManager.h"
+#include <algorithm>
+#include <functional>
 
 namespace ECSE
 {
 
 Entity::ID EntityManager::createEntity()
 {
-    Entity::ID newID = (++nextID) % getMaxIDCount();
-    if (newID == Entity::invalidID)
+    std::uint32_t index;
+    if (!freeIndices.empty())
     {
-        ++newID;
+        index = freeIndices.back();
+        freeIndices.pop_back();
     }
-
-    if (idMap[newID])
+    else
     {
-        bool found = false;
-
-        // This ID is taken; try to find a new one
-        for (Entity::ID i = Entity::invalidID + 1; i < getMaxIDCount(); ++i)
-        {
-            if (!idMap[i])
-            {
-                newID = i;
-                nextID = i + 1;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found)
+        if (slots.size() >= getMaxIDCount())
         {
             throw std::runtime_error("Out of Entity IDs!");
         }
+
+        index = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
     }
 
+    Slot& slot = slots[index];
+    Entity::ID newID = Entity::makeID(index, slot.generation);
+
     Entity* e = entityPool.construct();
     e->id = newID;
-    idMap[newID] = e;
+    slot.entity = e;
+    slot.position = entities.size();
     entities.push_back(e);
 
     return newID;
 }
 
-Entity* EntityManager::getEntity(Entity::ID id)
+std::vector<Entity::ID> EntityManager::createEntities(size_t count)
 {
-    if (idMap.find(id) == idMap.end())
+    // Slots are only added once the free ones run out
+    if (count > freeIndices.size())
     {
-        return nullptr;
+        slots.reserve(slots.size() + count - freeIndices.size());
+    }
+
+    entities.reserve(entities.size() + count);
+    entityPool.reserve(count);
+
+    std::vector<Entity::ID> ids;
+    ids.reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        ids.push_back(createEntity());
     }
 
-    return idMap[id];
+    return ids;
+}
+
+Entity* EntityManager::getEntity(Entity::ID id)
+{
+    Slot* slot = getSlot(id);
+
+    return slot ? slot->entity : nullptr;
 }
 
 void EntityManager::destroyEntity(Entity::ID id)
 {
-    Entity* e = idMap[id];
+    Slot* slot = getSlot(id);
 
-    if (!e)
+    if (!slot)
     {
         throw std::runtime_error("Tried to remove entity with ID #" + std::to_string(id) + " which does not exist!");
     }
 
-    idMap[id] = nullptr;
-    entities.erase(find(entities.begin(), entities.end(), e));
+    Entity* e = slot->entity;
+
+    releaseSlot(e);
     entityPool.destroy(e);
 }
 
@@ -70,4 +85,53 @@ void EntityManager::destroyEntity(Entity* entity)
     destroyEntity(entity->id);
 }
 
+void EntityManager::destroyEntities(std::vector<Entity*>& batch)
+{
+    for (Entity* e : batch)
+    {
+        releaseSlot(e);
+    }
+
+    // Free from the highest address down, so the memory is handed out again in address order
+    std::sort(batch.begin(), batch.end(), std::greater<Entity*>());
+    for (Entity* e : batch)
+    {
+        entityPool.destroy(e);
+    }
+}
+
+EntityManager::Slot* EntityManager::getSlot(Entity::ID id)
+{
+    std::uint32_t index = Entity::indexOf(id);
+    if (index == Entity::indexOf(Entity::invalidID) || index >= slots.size())
+    {
+        return nullptr;
+    }
+
+    Slot& slot = slots[index];
+    if (!slot.entity || slot.generation != Entity::generationOf(id))
+    {
+        return nullptr;
+    }
+
+    return &slot;
+}
+
+void EntityManager::releaseSlot(Entity* e)
+{
+    std::uint32_t index = Entity::indexOf(e->id);
+    Slot& slot = slots[index];
+
+    // Move the last Entity into the removed one's position
+    Entity* last = entities.back();
+    entities[slot.position] = last;
+    slots[Entity::indexOf(last->id)].position = slot.position;
+    entities.pop_back();
+
+    // Bump the generation so any IDs still referring to this slot become invalid
+    slot.entity = nullptr;
+    ++slot.generation;
+    freeIndices.push_back(index);
+}
+
 }
@@ -1,8 +1,10 @@
 #pragma once
 
-#include <unordered_map>
-#include <boost/pool/object_pool.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
 #include "Entity.h"
+#include "Pool.h"
 
 namespace ECSE
 {
@@ -24,6 +26,15 @@ public:
     */
     virtual Entity::ID createEntity();
 
+    //! Create many new Entities at once.
+    /*!
+    * Room is made for the whole batch first, so the Entities are allocated together.
+    *
+    * \param count The number of Entities.
+    * \return The IDs of the new Entities, in the order they were created.
+    */
+    virtual std::vector<Entity::ID> createEntities(size_t count);
+
     //! Get a pointer to an Entity by its ID.
     /*!
     * Note that Entity::invalidID (0) is never a valid ID.
@@ -48,30 +59,61 @@ public:
     */
     virtual void destroyEntity(Entity* entity);
 
+    //! Destroy many Entities at once.
+    /*!
+    * This is much faster than destroying them one at a time.
+    *
+    * \param batch Pointers to the Entities to remove, which must all be different. They're sorted in place.
+    */
+    virtual void destroyEntities(std::vector<Entity*>& batch);
+
     //! Get a vector of all the Entities.
     /*!
+    * The vector is the EntityManager's own, so it changes as Entities are created and destroyed.
+    *
     * \return A vector of all Entities.
     */
-    virtual inline const std::vector<Entity*> getEntities() const
+    inline const std::vector<Entity*>& getEntities() const
     {
         return entities;
     }
 
-    //! Get the maximum number of IDs, including Entity::invalidID.
+    //! Get the maximum number of Entity slots, including the one reserved for Entity::invalidID.
     /*!
-    * \return The maximum number of IDs.
+    * \return The maximum number of slots.
     */
     virtual Entity::ID getMaxIDCount() const
     {
-        return std::numeric_limits<Entity::ID>::max();
+        return static_cast<Entity::ID>(std::numeric_limits<std::uint32_t>::max()) + 1;
     }
 
 private:
-    //! The next entity ID to use.
-    Entity::ID nextID = Entity::invalidID + 1;
-    
-    //! Map from Entity ID to a pointer to the actual Entity.
-    std::unordered_map<Entity::ID, Entity*> idMap;
+    //! Holds an Entity and the generation of IDs that refer to it.
+    struct Slot
+    {
+        Entity* entity = nullptr;           //!< The Entity in this slot, or nullptr if it's free.
+        std::uint32_t generation = 0;       //!< Incremented every time the slot's Entity is destroyed.
+        std::size_t position = 0;           //!< The Entity's position in entities.
+    };
+
+    //! Get the slot an ID refers to.
+    /*!
+    * \param id The ID.
+    * \return The slot, or nullptr if the ID doesn't refer to a live Entity.
+    */
+    Slot* getSlot(Entity::ID id);
+
+    //! Free an Entity's slot and remove it from the vector of all entities, without destroying it.
+    /*!
+    * \param e The Entity.
+    */
+    void releaseSlot(Entity* e);
+
+    //! Entity slots, indexed by the low bits of the ID. Slot 0 is never used so invalidID stays invalid.
+    std::vector<Slot> slots = std::vector<Slot>(1);
+
+    //! Indices of free slots.
+    std::vector<std::uint32_t> freeIndices;
 
     //! Vector of all entities.
     /*!
@@ -81,7 +123,7 @@ private:
     std::vector<Entity*> entities;
 
     //! Pool from which Entities are allocated.
-    boost::object_pool<Entity> entityPool;
+    ObjectPool<Entity> entityPool;
 };
 
 
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "Entity.h"
+
+namespace ECSE
+{
+
+//! A range over a World's Entities which skips those waiting to be destroyed.
+/*!
+* Get one with World::getEntities. It refers to the EntityManager's own vector, so nothing is copied,
+* and Entities marked for destruction are skipped as the range is iterated.
+*
+* The range is only valid until an Entity is next created or destroyed.
+*/
+class EntityRange
+{
+public:
+    //! Iterates the live Entities of an EntityRange.
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Entity* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Entity* const* pointer;
+        typedef Entity* const& reference;
+
+        //! Construct the Iterator.
+        /*!
+        * \param current The first position, which is skipped if its Entity is being destroyed.
+        * \param end The end of the Entities.
+        */
+        Iterator(std::vector<Entity*>::const_iterator current, std::vector<Entity*>::const_iterator end)
+            : current(current), end(end)
+        {
+            skipDestroying();
+        }
+
+        //! Get the current Entity.
+        inline reference operator*() const
+        {
+            return *current;
+        }
+
+        //! Move to the next Entity which isn't being destroyed.
+        inline Iterator& operator++()
+        {
+            ++current;
+            skipDestroying();
+            return *this;
+        }
+
+        //! Move to the next Entity which isn't being destroyed.
+        inline Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        inline bool operator==(const Iterator& other) const
+        {
+            return current == other.current;
+        }
+
+        inline bool operator!=(const Iterator& other) const
+        {
+            return current != other.current;
+        }
+
+    private:
+        //! Skip Entities which are being destroyed.
+        inline void skipDestroying()
+        {
+            while (current != end && (*current)->isDestroying())
+            {
+                ++current;
+            }
+        }
+
+        std::vector<Entity*>::const_iterator current;   //!< The current position.
+        std::vector<Entity*>::const_iterator end;       //!< The end of the Entities.
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    //! Construct the EntityRange.
+    /*!
+    * \param entities All the Entities, including those being destroyed.
+    * \param count The number of Entities which aren't being destroyed.
+    */
+    EntityRange(const std::vector<Entity*>& entities, size_t count)
+        : entities(entities), count(count)
+    {
+    }
+
+    //! Get an Iterator to the first Entity.
+    inline Iterator begin() const
+    {
+        return Iterator(entities.begin(), entities.end());
+    }
+
+    //! Get an Iterator past the last Entity.
+    inline Iterator end() const
+    {
+        return Iterator(entities.end(), entities.end());
+    }
+
+    //! Get the number of Entities which aren't being destroyed.
+    inline size_t size() const
+    {
+        return count;
+    }
+
+    //! Check whether there are no Entities which aren't being destroyed.
+    inline bool empty() const
+    {
+        return count == 0;
+    }
+
+private:
+    const std::vector<Entity*>& entities;   //!< All the Entities, including those being destroyed.
+    size_t count;                           //!< The number of Entities which aren't being destroyed.
+};
+
+}
@@ -0,0 +1,55 @@
+#include "EntitySet.h"
+
+namespace ECSE
+{
+
+const size_t EntitySet::noPosition;
+
+bool EntitySet::insert(Entity* e)
+{
+    size_t index = Entity::indexOf(e->getID());
+    if (index >= sparse.size())
+    {
+        sparse.resize(index + 1, noPosition);
+    }
+    else if (sparse[index] != noPosition)
+    {
+        return false;
+    }
+
+    sparse[index] = dense.size();
+    dense.push_back(e);
+
+    return true;
+}
+
+bool EntitySet::erase(Entity* e)
+{
+    if (!contains(e)) return false;
+
+    size_t index = Entity::indexOf(e->getID());
+    size_t position = sparse[index];
+
+    // Swap the last Entity into the removed one's position
+    Entity* last = dense.back();
+    dense[position] = last;
+    sparse[Entity::indexOf(last->getID())] = position;
+
+    dense.pop_back();
+    sparse[index] = noPosition;
+
+    return true;
+}
+
+void EntitySet::clear()
+{
+    // Only the entries in use need resetting, so clearing a small set stays cheap
+    for (Entity* e : dense)
+    {
+        sparse[Entity::indexOf(e->getID())] = noPosition;
+    }
+
+    dense.clear();
+}
+
+}
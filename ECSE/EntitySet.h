@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Entity.h"
+
+namespace ECSE
+{
+
+//! A set of Entities stored as a sparse set, keyed by the Entities' slot indices.
+/*!
+* Entities are kept contiguously in the dense array and the sparse array maps each slot index to a
+* position in it, so adding, removing and checking for an Entity are constant time and iteration is
+* a walk over a plain array.
+*
+* Iteration is in the order Entities were added, except that removing an Entity moves the last one
+* into its place. Unlike a set of pointers, the order never depends on where Entities were allocated.
+*
+* Entities must have been created by an EntityManager, since their IDs are used as keys.
+*/
+class EntitySet
+{
+public:
+    typedef std::vector<Entity*>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    //! Add an Entity.
+    /*!
+    * \param e The Entity to add.
+    * \return Whether it was added, i.e. false if it was already in the set.
+    */
+    bool insert(Entity* e);
+
+    //! Remove an Entity.
+    /*!
+    * The last Entity is moved into its place.
+    *
+    * \param e The Entity to remove.
+    * \return Whether it was removed, i.e. false if it wasn't in the set.
+    */
+    bool erase(Entity* e);
+
+    //! Remove all the Entities.
+    void clear();
+
+    //! Check whether an Entity is in the set.
+    /*!
+    * \param e The Entity to check.
+    * \return Whether it's in the set.
+    */
+    inline bool contains(const Entity* e) const
+    {
+        size_t index = Entity::indexOf(e->getID());
+        return index < sparse.size() && sparse[index] != noPosition && dense[sparse[index]] == e;
+    }
+
+    //! Get the number of Entities in the set.
+    inline size_t size() const
+    {
+        return dense.size();
+    }
+
+    //! Check whether the set has no Entities.
+    inline bool empty() const
+    {
+        return dense.empty();
+    }
+
+    //! Get the Entity at a position in iteration order.
+    inline Entity* operator[](size_t position) const
+    {
+        return dense[position];
+    }
+
+    //! Get an iterator to the first Entity.
+    inline const_iterator begin() const
+    {
+        return dense.begin();
+    }
+
+    //! Get an iterator past the last Entity.
+    inline const_iterator end() const
+    {
+        return dense.end();
+    }
+
+private:
+    //! Value in sparse for a slot index whose Entity isn't in the set.
+    static const size_t noPosition = static_cast<size_t>(-1);
+
+    std::vector<Entity*> dense;     //!< The Entities in the set.
+    std::vector<size_t> sparse;     //!< The position in dense of each Entity, indexed by the Entity's slot index.
+};
+
+}
@@ -1,9 +1,172 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Component.h"
+
 namespace ECSE
 {
 
-//! Base class for object pools. Useful for maintaining containers of pointers to various Pool types.
+//! A pool of objects of one type, allocated in blocks.
+/*!
+* Freed objects' memory goes on a free list and is handed out again first, so both allocating and
+* freeing are constant time. (boost::object_pool keeps its free list sorted by address instead, so
+* every free walks the list, and freeing a batch one object at a time is quadratic.) Objects still
+* alive when the pool is destroyed are destroyed with it.
+*/
+template <typename T>
+class ObjectPool
+{
+public:
+    //! Construct an empty ObjectPool.
+    /*!
+    * \param nextSize The number of objects in the first block allocated.
+    */
+    explicit ObjectPool(size_t nextSize = 32) : nextSize(nextSize)
+    {
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    //! Destroy the ObjectPool and any objects still alive in it.
+    ~ObjectPool()
+    {
+        for (auto& block : blocks)
+        {
+            for (size_t i = 0; i < block.size; ++i)
+            {
+                if (block.slots[i].alive)
+                {
+                    reinterpret_cast<T*>(&block.slots[i].storage)->~T();
+                }
+            }
+        }
+    }
+
+    //! Allocate and default-construct an object.
+    /*!
+    * \return The object.
+    */
+    T* construct()
+    {
+        if (!freeList)
+        {
+            grow();
+        }
+
+        // The link shares memory with the object, so it has to be read before constructing
+        Slot* slot = freeList;
+        Slot* next = slot->next;
+
+        T* object;
+        try
+        {
+            object = new (&slot->storage) T();
+        }
+        catch (...)
+        {
+            slot->next = next;
+            throw;
+        }
+
+        freeList = next;
+        slot->alive = true;
+
+        return object;
+    }
+
+    //! Destroy an object and return its memory to the pool.
+    /*!
+    * \param object The object, which must have been allocated from this pool.
+    */
+    void destroy(T* object)
+    {
+        object->~T();
+
+        // The storage is the slot's first member, so the object's address is the slot's
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->alive = false;
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    //! Check whether an object's memory belongs to this pool.
+    /*!
+    * \param object The object.
+    * \return Whether it's in one of the pool's blocks.
+    */
+    bool isFrom(const T* object) const
+    {
+        const void* address = object;
+        for (auto& block : blocks)
+        {
+            const void* begin = block.slots.get();
+            const void* end = block.slots.get() + block.size;
+            if (!std::less<const void*>()(address, begin) && std::less<const void*>()(address, end)) return true;
+        }
+
+        return false;
+    }
+
+    //! Make sure the next block of memory the pool allocates has room for a number of objects.
+    /*!
+    * Objects allocated once the pool's free memory runs out are then contiguous.
+    *
+    * \param count The number of objects.
+    */
+    void reserve(size_t count)
+    {
+        nextSize = std::max(nextSize, count);
+    }
+
+private:
+    //! Memory for one object, which links to the next free slot while it's not in use.
+    struct Slot
+    {
+        union
+        {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;    //!< The object.
+            Slot* next;                                                             //!< The next free slot.
+        };
+        bool alive;     //!< Whether storage holds an object.
+    };
+
+    //! A contiguous array of Slots.
+    struct Block
+    {
+        std::unique_ptr<Slot[]> slots;  //!< The Slots.
+        size_t size;                    //!< The number of Slots.
+    };
+
+    //! Allocate a new block and put its slots on the free list, so they're handed out in address order.
+    void grow()
+    {
+        Block block{ std::unique_ptr<Slot[]>(new Slot[nextSize]), nextSize };
+        for (size_t i = block.size; i-- > 0;)
+        {
+            block.slots[i].alive = false;
+            block.slots[i].next = freeList;
+            freeList = &block.slots[i];
+        }
+
+        blocks.push_back(std::move(block));
+        nextSize *= 2;
+    }
+
+    std::vector<Block> blocks;  //!< The blocks of memory objects are allocated from.
+    Slot* freeList = nullptr;   //!< The first free slot.
+    size_t nextSize;            //!< The number of slots in the next block allocated.
+};
+
+//! Base class for Component pools. Useful for maintaining containers of pointers to various Pool types.
 /*!
 * This class should probably only be used if you want to have a bunch of different pools of different
 * types and need a base class pointer. Otherwise, you're just wasting time and space on this.
@@ -11,17 +174,138 @@ namespace ECSE
 struct PoolBase
 {
     virtual ~PoolBase() { }
+
+    //! Destroy an object and return its memory to the pool.
+    /*!
+    * \param object The object, which must have been allocated from this pool.
+    */
+    virtual void destroy(Component* object) = 0;
+
+    //! Destroy many objects and return their memory to the pool.
+    /*!
+    * The memory is freed in an order which hands it out again in address order.
+    *
+    * \param objects The objects, which must all have been allocated from this pool. They're sorted in place.
+    */
+    virtual void destroyBatch(std::vector<Component*>& objects) = 0;
+
+    //! Make room for a number of objects to be allocated together.
+    /*!
+    * \param count The number of objects.
+    */
+    virtual void reserve(size_t count) = 0;
+
+    //! Check whether an object was allocated from this pool.
+    /*!
+    * \param object The object.
+    * \return Whether it belongs to this pool.
+    */
+    virtual bool isFrom(Component* object) const = 0;
+
+    //! Move an object out of the pool.
+    /*!
+    * The object is move-constructed at the destination, then the original is destroyed and its memory
+    * is returned to the pool.
+    *
+    * \param object The object, which must have been allocated from this pool.
+    * \param destination Uninitialized memory with the size and alignment of the pool's type.
+    * \return The moved object.
+    */
+    virtual Component* relocate(Component* object, void* destination) = 0;
+
+    //! Check whether objects in the pool can be relocated.
+    virtual bool isRelocatable() const = 0;
+
+    //! Get the size of the pool's type.
+    virtual size_t getObjectSize() const = 0;
+
+    //! Get the alignment of the pool's type.
+    virtual size_t getObjectAlignment() const = 0;
 };
 
-//! Specialized collection for each class type.
+//! Specialized collection for each Component type.
 /*!
 * \see PoolBase
 */
 template <typename T>
 struct Pool : PoolBase
 {
+    void destroy(Component* object) override
+    {
+        pool.destroy(static_cast<T*>(object));
+    }
+
+    void destroyBatch(std::vector<Component*>& objects) override
+    {
+        // Free from the highest address down, so the memory is handed out again in address order
+        std::sort(objects.begin(), objects.end(), [](Component* a, Component* b)
+        {
+            return std::greater<T*>()(static_cast<T*>(a), static_cast<T*>(b));
+        });
+
+        for (Component* object : objects)
+        {
+            pool.destroy(static_cast<T*>(object));
+        }
+    }
+
+    void reserve(size_t count) override
+    {
+        pool.reserve(count);
+    }
+
+    bool isFrom(Component* object) const override
+    {
+        return pool.isFrom(static_cast<T*>(object));
+    }
+
+    Component* relocate(Component* object, void* destination) override
+    {
+        return relocate(object, destination, std::is_move_constructible<T>());
+    }
+
+    bool isRelocatable() const override
+    {
+        return std::is_move_constructible<T>::value;
+    }
+
+    size_t getObjectSize() const override
+    {
+        return sizeof(T);
+    }
+
+    size_t getObjectAlignment() const override
+    {
+        return alignof(T);
+    }
+
     //! The actual object pool.
-    boost::object_pool<T> pool;
+    ObjectPool<T> pool;
+
+private:
+    //! Move an object out of the pool.
+    Component* relocate(Component* object, void* destination, std::true_type)
+    {
+        T* original = static_cast<T*>(object);
+        T* moved = new (destination) T(std::move(*original));
+        pool.destroy(original);
+
+#ifndef NDEBUG
+        // Poison the old object so stale pointers to it fail loudly. The pool keeps its free list link at the start.
+        if (sizeof(T) > sizeof(void*))
+        {
+            std::memset(reinterpret_cast<unsigned char*>(original) + sizeof(void*), 0xDD, sizeof(T) - sizeof(void*));
+        }
+#endif
+
+        return moved;
+    }
+
+    //! Fail to move an object that can't be moved.
+    Component* relocate(Component* object, void* destination, std::false_type)
+    {
+        throw std::runtime_error("Tried to relocate a Component type which isn't move-constructible");
+    }
 };
 
 }
@@ -10,7 +10,7 @@ namespace ECSE
 
 bool RenderSystem::hasEntity(const Entity& e) const
 {
-    return layers.find(const_cast<Entity*>(&e)) != layers.end();
+    return members.contains(&e);
 }
 
 void RenderSystem::added()
@@ -30,13 +30,10 @@ void RenderSystem::added()
 
 void RenderSystem::update(sf::Time deltaTime)
 {
-    for (auto& pair : layers)
+    // Sprites with their SpriteComponent disabled are skipped by the view
+    for (auto components : view<SpriteComponent>())
     {
-        auto spriteComponent = pair.first->getComponent<SpriteComponent>();
-        if (!spriteComponent->enabled) continue;
-
-        auto& sprite = spriteComponent->sprite;
-        sprite.update(deltaTime);
+        std::get<0>(components).sprite.update(deltaTime);
     }
 }
 
@@ -56,15 +53,6 @@ void RenderSystem::render(float alpha, sf::RenderTarget& renderTarget)
     }
 }
 
-bool RenderSystem::checkRequirements(const Entity& e) const
-{
-    if (!e.getComponent<TransformComponent>()) return false;
-    if (!e.getComponent<SpriteComponent>()) return false;
-    if (!e.getComponent<DepthComponent>()) return false;
-
-    return true;
-}
-
 void RenderSystem::updateSpritePos(float alpha, Entity& entity)
 {
     SpriteComponent& sc = *entity.getComponent<SpriteComponent>();
@@ -92,7 +80,15 @@ void RenderSystem::internalAddEntity(Entity& e)
 
     int layer = e.getComponent<DepthComponent>()->depth;
 
-    layers[&e] = layer;
+    size_t index = Entity::indexOf(e.getID());
+    if (index >= layers.size())
+    {
+        layers.resize(index + 1);
+    }
+
+    layers[index] = layer;
+    members.insert(&e);
+    viewIndices.add(e);
     entities[layer].insert(&e);
 }
 
@@ -100,33 +96,42 @@ void RenderSystem::internalRemoveEntity(Entity& e)
 {
     VLOG(2) << "Entity #" << e.getID() << " removed from RenderSystem";
 
-    int layer = e.getComponent<DepthComponent>()->depth;
+    // Use the layer it was sorted into, since its depth may have changed since
+    int layer = layers[Entity::indexOf(e.getID())];
 
-    layers.erase(&e);
+    members.erase(&e);
+    viewIndices.remove(e);
 
-    auto& entitySet = entities[layer];
-    entitySet.erase(&e);
+    auto found = entities.find(layer);
+    found->second.erase(&e);
 
     // Remove empty layer
-    if (entitySet.empty())
+    if (found->second.empty())
     {
-        entities.erase(layer);
+        entities.erase(found);
     }
 }
 
 void RenderSystem::sortLayers()
 {
-    for (auto& pair : layers)
+    for (Entity* e : members)
     {
-        int layer = pair.first->getComponent<DepthComponent>()->depth;
+        int layer = e->getComponent<DepthComponent>()->depth;
+        int& current = layers[Entity::indexOf(e->getID())];
 
         // Change layers
-        if (pair.second != layer)
+        if (current != layer)
         {
-            entities[pair.second].erase(pair.first);
+            auto found = entities.find(current);
+            found->second.erase(e);
+
+            if (found->second.empty())
+            {
+                entities.erase(found);
+            }
 
-            pair.second = layer;
-            entities[layer].insert(pair.first);
+            current = layer;
+            entities[layer].insert(e);
         }
     }
 }
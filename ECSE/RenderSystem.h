@@ -1,8 +1,13 @@
 #pragma once
 
+#include "DepthComponent.h"
+#include "EntitySet.h"
+#include "SpriteComponent.h"
 #include "System.h"
 #include "TransformSystem.h"
+#include "View.h"
 #include <map>
+#include <vector>
 
 namespace ECSE
 {
@@ -20,7 +25,10 @@ class RenderSystem :
 {
 public:
     //! Construct the RenderSystem.
-    explicit RenderSystem(World* world) : System(world) {}
+    explicit RenderSystem(World* world) : System(world)
+    {
+        require<TransformComponent, SpriteComponent, DepthComponent>();
+    }
 
     //! Return whether an Entity is already in the RenderSystem.
     /*!
@@ -32,6 +40,26 @@ public:
     //! Called when all Systems have been added to the world.
     void added() override;
 
+    //! Get a range over this System's Entities which have all of the given Component types.
+    /*!
+    * This works like SetSystem::view. Every Entity in the RenderSystem has its required types, so
+    * a View of any of those has the Entities in the order they were added, regardless of layer.
+    *
+    * \tparam ComponentTypes The Component types. Base types given by ExtendsComponent also match.
+    * \return The View.
+    */
+    template <typename... ComponentTypes>
+    View<ComponentTypes...> view()
+    {
+        ComponentMask mask;
+        for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+        {
+            mask.set(typeID);
+        }
+
+        return View<ComponentTypes...>(viewIndices.get(mask, members));
+    }
+
     //! Called on an update step.
     /*!
     * Sprites' frames are updated.
@@ -47,13 +75,6 @@ public:
     */
     virtual void render(float alpha, sf::RenderTarget& renderTarget) override;
 
-    //! Check whether an Entity meets the requirements to be added to this System.
-    /*!
-    * \param e The Entity to check.
-    * \return Whether the Entity matches this System's requirements.
-    */
-    virtual bool checkRequirements(const Entity& e) const override;
-
 protected:
     //! Update the position of an entity's sprite.
     /*!
@@ -100,10 +121,16 @@ protected:
     // Data
 
     //! Map from layer index to set of Entities in the layer, sorted from highest to lowest layer.
-    std::map<int, std::set<Entity*>, std::greater<int>> entities;
+    std::map<int, EntitySet, std::greater<int>> entities;
+
+    //! All the Entities in the RenderSystem, in the order they're checked for layer changes.
+    EntitySet members;
+
+    //! Indices of the members for each set of viewed Component types.
+    ViewIndexSet viewIndices;
 
-    //! Map from Entity to layer index.
-    std::map<Entity*, int> layers;
+    //! The layer index each Entity is currently sorted into, indexed by the Entity's slot index.
+    std::vector<int> layers;
 };
 
 }
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <set>
+#include "EntitySet.h"
 #include "System.h"
+#include "View.h"
 #include "Logging.h"
 
 namespace ECSE
@@ -25,15 +26,36 @@ public:
     */
     virtual inline bool hasEntity(const Entity& e) const override
     {
-        return entities.find(const_cast<Entity*>(&e)) != entities.end();
+        return entities.contains(&e);
     }
 
     //! Get the Entities contained in the SetSystem.
-    inline const std::set<Entity*>& getEntities() const
+    inline const EntitySet& getEntities() const
     {
         return entities;
     }
 
+    //! Get a range over this System's Entities which have all of the given Component types.
+    /*!
+    * This works like World::view, but only has the Entities this System accepted. Entities join and
+    * leave it as they join and leave the System. If every one of them has the types, e.g. because the
+    * System requires them, the View's rows are in the same order as getEntities.
+    *
+    * \tparam ComponentTypes The Component types. Base types given by ExtendsComponent also match.
+    * \return The View.
+    */
+    template <typename... ComponentTypes>
+    View<ComponentTypes...> view()
+    {
+        ComponentMask mask;
+        for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+        {
+            mask.set(typeID);
+        }
+
+        return View<ComponentTypes...>(viewIndices.get(mask, entities));
+    }
+
 protected:
     //! Add an Entity to the internal Entity set.
     /*!
@@ -43,7 +65,10 @@ protected:
     {
         VLOG(2) << "Entity #" << e.getID() << " added to SetSystem";
 
-        entities.insert(&e);
+        if (entities.insert(&e))
+        {
+            viewIndices.add(e);
+        }
     }
 
     //! Remove an Entity from the internal Entity set.
@@ -54,11 +79,15 @@ protected:
     {
         VLOG(2) << "Entity #" << e.getID() << " removed from SetSystem";
 
-        entities.erase(&e);
+        if (entities.erase(&e))
+        {
+            viewIndices.remove(e);
+        }
     }
 
 private:
-    std::set<Entity*> entities;   //!< The set of Entities operated on by this SetSystem.
+    EntitySet entities;         //!< The set of Entities operated on by this SetSystem.
+    ViewIndexSet viewIndices;   //!< Indices of this System's Entities for each set of viewed Component types.
 };
 
 }
@@ -47,13 +47,6 @@ void SpecializationSystem::render(float alpha, sf::RenderTarget& renderTarget)
     }
 }
 
-bool SpecializationSystem::checkRequirements(const Entity& e) const
-{
-    if (!e.getComponent<SpecializationComponent>()) return false;
-
-    return true;
-}
-
 void SpecializationSystem::internalAddEntity(Entity& e)
 {
     SetSystem::internalAddEntity(e);
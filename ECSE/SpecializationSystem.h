@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SetSystem.h"
+#include "SpecializationComponent.h"
 
 namespace ECSE
 {
@@ -10,7 +11,10 @@ class SpecializationSystem : public SetSystem
 {
 public:
     //! Construct the SpecializationSystem.
-    explicit SpecializationSystem(World* world) : SetSystem(world) {}
+    explicit SpecializationSystem(World* world) : SetSystem(world)
+    {
+        require<SpecializationComponent>();
+    }
 
     //! Called on an update step.
     /*!
@@ -28,13 +32,6 @@ public:
     */
     void render(float alpha, sf::RenderTarget& renderTarget) override;
 
-    //! Check whether an Entity meets the requirements to be added to this System.
-    /*!
-    * \param e The Entity to check.
-    * \return Whether the Entity matches this System's requirements.
-    */
-    bool checkRequirements(const Entity& e) const override;
-
 protected:
     //! Add an Entity to the internal Entity set.
     /*!
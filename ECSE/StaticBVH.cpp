@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include "StaticBVH.h"
+
+namespace ECSE
+{
+
+const size_t StaticBVH::notFound;
+
+//! Find the distance from a point to the closest point in an AABB.
+/*!
+* \param point The point.
+* \param bounds The AABB.
+* \return The distance, or 0 if the point is inside.
+*/
+static float getDistance(sf::Vector2f point, const AABB& bounds)
+{
+    float dx = std::max(std::max(bounds.min.x - point.x, point.x - bounds.max.x), 0.f);
+    float dy = std::max(std::max(bounds.min.y - point.y, point.y - bounds.max.y), 0.f);
+
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void StaticBVH::build(const std::vector<AABB>& bounds)
+{
+    clear();
+
+    if (bounds.empty()) return;
+
+    itemBounds = bounds;
+    items.resize(bounds.size());
+    std::iota(items.begin(), items.end(), 0);
+
+    // A binary tree with this many leaves has fewer than twice as many nodes
+    nodes.reserve(2 * (bounds.size() / maxLeafSize + 1));
+    nodes.push_back(Node());
+    buildNode(0, 0, items.size());
+}
+
+void StaticBVH::clear()
+{
+    nodes.clear();
+    items.clear();
+    itemBounds.clear();
+}
+
+void StaticBVH::query(const AABB& bounds, std::vector<size_t>& results) const
+{
+    results.clear();
+
+    if (nodes.empty()) return;
+
+    // Each level pushes at most two nodes and pops one, so this is deeper than any balanced tree we'll build
+    size_t stack[128];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = nodes[stack[--stackSize]];
+        if (!node.bounds.overlaps(bounds)) continue;
+
+        if (node.count > 0)
+        {
+            for (size_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (itemBounds[items[i]].overlaps(bounds)) results.push_back(items[i]);
+            }
+        }
+        else
+        {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+        }
+    }
+}
+
+size_t StaticBVH::raycast(sf::Vector2f start, sf::Vector2f end, const DistanceFunction& hitTest, float& time) const
+{
+    size_t result = notFound;
+    float best = std::numeric_limits<float>::max();
+
+    if (nodes.empty()) return result;
+
+    size_t stack[128];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = nodes[stack[--stackSize]];
+
+        float enter = raycastAABB(start, end, node.bounds);
+        if (enter < 0.f || enter > best) continue;
+
+        if (node.count > 0)
+        {
+            for (size_t i = node.first; i < node.first + node.count; ++i)
+            {
+                float itemEnter = raycastAABB(start, end, itemBounds[items[i]]);
+                if (itemEnter < 0.f || itemEnter > best) continue;
+
+                float hit = hitTest(items[i]);
+                if (hit >= 0.f && hit < best)
+                {
+                    best = hit;
+                    result = items[i];
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first so the further one is more likely to be skipped
+            bool leftFirst = raycastAABB(start, end, nodes[node.first].bounds) <=
+                             raycastAABB(start, end, nodes[node.first + 1].bounds);
+            stack[stackSize++] = leftFirst ? node.first + 1 : node.first;
+            stack[stackSize++] = leftFirst ? node.first : node.first + 1;
+        }
+    }
+
+    if (result != notFound) time = best;
+    return result;
+}
+
+size_t StaticBVH::nearest(sf::Vector2f point, float maxDistance, const DistanceFunction& distanceTest, float& distance) const
+{
+    size_t result = notFound;
+    float best = maxDistance;
+
+    if (nodes.empty()) return result;
+
+    size_t stack[128];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = nodes[stack[--stackSize]];
+        if (getDistance(point, node.bounds) >= best) continue;
+
+        if (node.count > 0)
+        {
+            for (size_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (getDistance(point, itemBounds[items[i]]) >= best) continue;
+
+                float itemDistance = distanceTest(items[i]);
+                if (itemDistance >= 0.f && itemDistance < best)
+                {
+                    best = itemDistance;
+                    result = items[i];
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first so the further one is more likely to be skipped
+            bool leftFirst = getDistance(point, nodes[node.first].bounds) <=
+                             getDistance(point, nodes[node.first + 1].bounds);
+            stack[stackSize++] = leftFirst ? node.first + 1 : node.first;
+            stack[stackSize++] = leftFirst ? node.first : node.first + 1;
+        }
+    }
+
+    if (result != notFound) distance = best;
+    return result;
+}
+
+void StaticBVH::buildNode(size_t nodeIndex, size_t first, size_t count)
+{
+    AABB bounds;
+    AABB centers;
+
+    for (size_t i = first; i < first + count; ++i)
+    {
+        const AABB& item = itemBounds[items[i]];
+        bounds.include(item.min);
+        bounds.include(item.max);
+        centers.include((item.min + item.max) * 0.5f);
+    }
+
+    nodes[nodeIndex].bounds = bounds;
+
+    if (count <= maxLeafSize)
+    {
+        nodes[nodeIndex].first = first;
+        nodes[nodeIndex].count = count;
+        return;
+    }
+
+    // Split at the median along whichever axis the centers are most spread out
+    bool splitX = (centers.max.x - centers.min.x) >= (centers.max.y - centers.min.y);
+    size_t half = count / 2;
+
+    std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                     [this, splitX](size_t a, size_t b)
+    {
+        const AABB& boundsA = itemBounds[a];
+        const AABB& boundsB = itemBounds[b];
+
+        return splitX ? (boundsA.min.x + boundsA.max.x) < (boundsB.min.x + boundsB.max.x)
+                      : (boundsA.min.y + boundsA.max.y) < (boundsB.min.y + boundsB.max.y);
+    });
+
+    // Children are allocated together so the right child is always next to the left
+    size_t children = nodes.size();
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+
+    nodes[nodeIndex].first = children;
+    nodes[nodeIndex].count = 0;
+
+    buildNode(children, first, half);
+    buildNode(children + 1, first + half, count - half);
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "CollisionMath.h"
+
+namespace ECSE
+{
+
+//! An immutable bounding volume hierarchy over a fixed set of bounds.
+/*!
+* Building is relatively expensive, so this is meant for things which never move (e.g. level geometry).
+* Bounds are identified by their index in the vector passed to build.
+*/
+class StaticBVH
+{
+public:
+    //! Build the hierarchy, replacing anything that was in it before.
+    /*!
+    * \param bounds The bounds to store.
+    */
+    void build(const std::vector<AABB>& bounds);
+
+    //! Remove everything from the hierarchy.
+    void clear();
+
+    //! Find the indices of all stored bounds which overlap some other bounds.
+    /*!
+    * \param bounds The bounds to check.
+    * \param results Filled with the overlapping indices. Existing contents are cleared.
+    */
+    void query(const AABB& bounds, std::vector<size_t>& results) const;
+
+    //! Finds the exact distance to a stored item, or a negative value if the item should be ignored.
+    typedef std::function<float(size_t)> DistanceFunction;
+
+    //! Find the first item hit by a line segment.
+    /*!
+    * Only items whose bounds the segment passes through are tested, and nodes further along the segment
+    * than the best hit so far are skipped.
+    * \param start The start of the segment.
+    * \param end The end of the segment.
+    * \param hitTest Finds the distance along the segment (0 - 1) at which it hits an item.
+    * \param time Set to the distance along the segment of the hit, if there was one.
+    * \return The index of the item which was hit first, or notFound.
+    */
+    size_t raycast(sf::Vector2f start, sf::Vector2f end, const DistanceFunction& hitTest, float& time) const;
+
+    //! Find the item closest to a point.
+    /*!
+    * Nodes whose bounds are further away than the closest item so far are skipped.
+    * \param point The point.
+    * \param maxDistance Items at least this far away are ignored.
+    * \param distanceTest Finds the distance from the point to an item.
+    * \param distance Set to the distance of the closest item, if there was one.
+    * \return The index of the closest item, or notFound.
+    */
+    size_t nearest(sf::Vector2f point, float maxDistance, const DistanceFunction& distanceTest, float& distance) const;
+
+    //! Get the number of bounds stored in the hierarchy.
+    /*!
+    * \return The number of bounds.
+    */
+    inline size_t size() const
+    {
+        return itemBounds.size();
+    }
+
+    //! Get the bounds of everything in the hierarchy.
+    /*!
+    * \return The root bounds, or an empty AABB if the hierarchy is empty.
+    */
+    inline AABB getBounds() const
+    {
+        return nodes.empty() ? AABB() : nodes[0].bounds;
+    }
+
+    //! The maximum number of bounds stored in a leaf node.
+    static const size_t maxLeafSize = 4;
+
+    //! Returned by raycast and nearest when nothing was found.
+    static const size_t notFound = static_cast<size_t>(-1);
+
+private:
+    //! A node in the hierarchy.
+    struct Node
+    {
+        AABB bounds;        //!< The bounds of everything under this node.
+        size_t first;       //!< For a leaf, the first index into items. Otherwise, the index of the first child.
+        size_t count;       //!< For a leaf, the number of items. Zero if this isn't a leaf.
+    };
+
+    //! Recursively build a node.
+    /*!
+    * \param nodeIndex The index of the node to build.
+    * \param first The first index into items covered by this node.
+    * \param count The number of items covered by this node.
+    */
+    void buildNode(size_t nodeIndex, size_t first, size_t count);
+
+    std::vector<Node> nodes;        //!< The nodes, with the root first. The children of a branch are adjacent.
+    std::vector<size_t> items;      //!< Indices of the stored bounds, ordered so each leaf covers a contiguous range.
+    std::vector<AABB> itemBounds;   //!< The stored bounds, by original index.
+};
+
+}
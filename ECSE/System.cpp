@@ -59,12 +59,20 @@ void System::inspectEntity(Entity& e)
 {
     VLOG(2) << "Inspecting Entity #" << e.getID();
 
+    // The caller has already matched the signature
+    assert(matchesSignature(e.getComponentMask()));
+
     if (checkRequirements(e))
     {
         markToAdd(e);
     }
 }
 
+bool System::checkRequirements(const Entity&) const
+{
+    return true;
+}
+
 void System::markToRemove(Entity& e)
 {
     if (!hasEntity(e))
@@ -73,7 +81,7 @@ void System::markToRemove(Entity& e)
         return;
     }
 
-    if (toRemove.find(&e) != toRemove.end())
+    if (toRemove.contains(&e))
     {
         LOG(WARNING) << "Marked the same Entity for removal more than once";
         return;
@@ -92,7 +100,7 @@ void System::markToAdd(Entity& e)
         return;
     }
 
-    if (toAdd.find(&e) != toAdd.end())
+    if (toAdd.contains(&e))
     {
         LOG(WARNING) << "Marked the same Entity for adding more than once";
         return;
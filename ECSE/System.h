@@ -1,9 +1,9 @@
 #pragma once
 
-#include <set>
 #include <SFML/System.hpp>
 #include <SFML/Graphics.hpp>
 #include "Entity.h"
+#include "EntitySet.h"
 
 namespace ECSE
 {
@@ -68,15 +68,38 @@ public:
 
     //! Check whether an Entity needs to be tracked by this System, and if so, mark it to be added on the next advance.
     /*!
-    * This function should only be called once per Entity.
-    * You probably want to override checkRequirements instead of this
-    * function, as it deals specifically with the Entity's requirements
-    * to be added.
+    * This function should only be called once per Entity, and only for Entities which match the
+    * System's signature (see matchesSignature). World checks the signature before calling this, so
+    * it isn't checked again here. You probably want to declare the signature with require and
+    * exclude, and override checkRequirements for anything more specific, instead of overriding
+    * this function.
     * 
     * \param e The entity to inspect.
     */
     void inspectEntity(Entity& e);
 
+    //! Check whether a set of Component types matches this System's signature.
+    /*!
+    * \param mask The Component types, e.g. from Entity::getComponentMask.
+    * \return Whether mask has all the required types and none of the excluded ones.
+    */
+    inline bool matchesSignature(const ComponentMask& mask) const
+    {
+        return (mask & requiredComponents) == requiredComponents && (mask & excludedComponents).none();
+    }
+
+    //! Get the Component types an Entity must have to be added to this System.
+    inline const ComponentMask& getRequiredComponents() const
+    {
+        return requiredComponents;
+    }
+
+    //! Get the Component types an Entity must not have to be added to this System.
+    inline const ComponentMask& getExcludedComponents() const
+    {
+        return excludedComponents;
+    }
+
     //! Mark an Entity to be removed from the System on the next call to addAndRemove.
     /*!
     * \param e The Entity to remove.
@@ -108,10 +131,32 @@ protected:
 
     //! Check whether an Entity meets the requirements to be added to this System.
     /*!
+    * This is only called for Entities which match the System's signature, so it only needs to
+    * check requirements the signature can't express. By default, it accepts every Entity, so a
+    * System which neither calls require nor overrides this will accept every Entity in the World.
+    *
     * \param e The Entity to check.
     * \return Whether the Entity matches this System's requirements.
     */
-    virtual bool checkRequirements(const Entity& e) const = 0;
+    virtual bool checkRequirements(const Entity& e) const;
+
+    //! Add Component types to those an Entity must have to be added to this System.
+    /*!
+    * This should be called from the constructor, before any Entities are inspected.
+    *
+    * \tparam ComponentTypes The Component types.
+    */
+    template <typename... ComponentTypes>
+    void require();
+
+    //! Add Component types to those an Entity must not have to be added to this System.
+    /*!
+    * This should be called from the constructor, before any Entities are inspected.
+    *
+    * \tparam ComponentTypes The Component types.
+    */
+    template <typename... ComponentTypes>
+    void exclude();
 
 
     // Data
@@ -126,8 +171,31 @@ private:
     */
     void markToAdd(Entity& e);
 
-    std::set<Entity*> toAdd;    //!< Entities to be added to the System on the next call to addAndRemove.
-    std::set<Entity*> toRemove; //!< Entities to be removed from the System on the next call to addAndRemove.
+    EntitySet toAdd;                    //!< Entities to be added to the System on the next call to addAndRemove.
+    EntitySet toRemove;                 //!< Entities to be removed from the System on the next call to addAndRemove.
+    ComponentMask requiredComponents;   //!< Component types an Entity must have to be added.
+    ComponentMask excludedComponents;   //!< Component types an Entity must not have to be added.
 };
 
+/////////////////
+// Implementation
+
+template <typename... ComponentTypes>
+void System::require()
+{
+    for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+    {
+        requiredComponents.set(typeID);
+    }
+}
+
+template <typename... ComponentTypes>
+void System::exclude()
+{
+    for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+    {
+        excludedComponents.set(typeID);
+    }
+}
+
 }
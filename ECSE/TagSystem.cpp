@@ -3,26 +3,19 @@
 
 namespace ECSE {
 
-std::set<Entity*> TagSystem::findWithTag(size_t tag) const
+std::vector<Entity*> TagSystem::findWithTag(size_t tag) const
 {
-    std::set<Entity*> results;
+    std::vector<Entity*> results;
 
     for (auto entity : getEntities())
     {
         if (entity->getComponent<TagComponent>()->hasTag(tag))
         {
-            results.insert(entity);
+            results.push_back(entity);
         }
     }
 
     return results;
 }
 
-bool TagSystem::checkRequirements(const Entity& e) const
-{
-    if (!e.getComponent<TagComponent>()) return false;
-
-    return true;
-}
-
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SetSystem.h"
+#include "TagComponent.h"
+#include <vector>
 
 namespace ECSE {
 
@@ -10,21 +12,17 @@ class TagSystem :
 {
 public:
     //! Construct the TransformSystem.
-    explicit TagSystem(World* world) : SetSystem(world) {}
+    explicit TagSystem(World* world) : SetSystem(world)
+    {
+        require<TagComponent>();
+    }
 
     //! Find all entities in the system with a given tag.
     /*!
     * \param tag The tag to check.
-    * \return The set of entities with that tag.
+    * \return The entities with that tag, in the order they're stored in the system.
     */
-    std::set<Entity*> findWithTag(size_t tag) const;
-
-    //! Check whether an Entity meets the requirements to be added to this System.
-    /*!
-    * \param e The Entity to check.
-    * \return Whether the Entity matches this System's requirements.
-    */
-    bool checkRequirements(const Entity& e) const override;
+    std::vector<Entity*> findWithTag(size_t tag) const;
 };
 
 }
@@ -43,6 +43,7 @@ public:
     inline void setNextLocalPosition(const sf::Vector2f& newPosition, bool discrete = false)
     {
         deltaPosition = newPosition - position;
+        ++version;
         discretePosition = discrete;
     }
 
@@ -57,6 +58,7 @@ public:
     inline void setNextLocalAngle(float newAngle, bool discrete = false, bool clockwise = false)
     {
         deltaAngle = newAngle - angle;
+        ++version;
         discreteAngle = discrete;
     }
 
@@ -70,6 +72,7 @@ public:
     inline void setDeltaPosition(const sf::Vector2f& newDeltaPosition, bool discrete = false)
     {
         deltaPosition = newDeltaPosition;
+        ++version;
         discretePosition = discrete;
     }
 
@@ -83,6 +86,7 @@ public:
     inline void setDeltaAngle(float newDeltaAngle, bool discrete = false)
     {
         deltaAngle = newDeltaAngle;
+        ++version;
         discreteAngle = discrete;
     }
 
@@ -94,6 +98,7 @@ public:
     inline void setLocalPosition(const sf::Vector2f& newPosition, bool setNext = true)
     {
         position = newPosition;
+        ++version;
         if (setNext) setDeltaPosition(sf::Vector2f());
     }
 
@@ -105,6 +110,7 @@ public:
     inline void setLocalAngle(float newAngle, bool setNext = true)
     {
         angle = newAngle;
+        ++version;
         if (setNext) setDeltaAngle(0.f);
     }
 
@@ -180,6 +186,17 @@ public:
         return discreteAngle;
     }
 
+    //! Get the write version.
+    /*!
+    * This is incremented whenever the position or angle is set, so that other Systems can tell whether
+    * the transform has been touched without comparing its values.
+    * \return The write version.
+    */
+    inline unsigned getVersion() const
+    {
+        return version;
+    }
+
     //! Set the current values to their next values and sets movement back to linear for the new timestep.
     inline void advance()
     {
@@ -193,6 +210,12 @@ public:
         discreteAngle = false;
     }
 
+    //! Get the id of the Entity to which this is parented.
+    inline Entity::ID getParent() const
+    {
+        return parent;
+    }
+
     //! Get the children parented to this component.
     inline const std::vector<Entity::ID> getChildren() const
     {
@@ -211,6 +234,8 @@ private:
     bool discretePosition = false;              //!< Whether the position change in this timestep should be a discrete jump.
     bool discreteAngle = false;                 //!< Whether the angle change in this timestep should be a discrete jump.
 
+    unsigned version = 0;                       //!< Incremented whenever the position or angle is set.
+
     Entity::ID parent = Entity::invalidID;      //!< The id of the Entity to which this is parented.
     std::vector<Entity::ID> children;           //!< Entity ids parented to this component.
 };
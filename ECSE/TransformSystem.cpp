@@ -9,22 +9,13 @@ void TransformSystem::advance()
 {
     SetSystem::advance();
 
-    for (Entity* entity : getEntities())
+    // The view skips disabled transforms
+    for (auto components : view<TransformComponent>())
     {
-        TransformComponent* tc = entity->getComponent<TransformComponent>();
-        if (!tc->enabled) continue;
-
-        tc->advance();
+        std::get<0>(components).advance();
     }
 }
 
-bool TransformSystem::checkRequirements(const Entity& e) const
-{
-    if (!e.getComponent<TransformComponent>()) return false;
-
-    return true;
-}
-
 void TransformSystem::markToRemove(Entity& e)
 {
     auto trans = e.getComponent<TransformComponent>();
@@ -12,7 +12,10 @@ class TransformSystem :
 {
 public:
     //! Construct the TransformSystem.
-    explicit TransformSystem(World* world) : SetSystem(world) {}
+    explicit TransformSystem(World* world) : SetSystem(world)
+    {
+        require<TransformComponent>();
+    }
 
     //! Called on an advance step.
     /*!
@@ -20,13 +23,6 @@ public:
     */
     void advance() override;
 
-    //! Check whether an Entity meets the requirements to be added to this System.
-    /*!
-    * \param e The Entity to check.
-    * \return Whether the Entity matches this System's requirements.
-    */
-    bool checkRequirements(const Entity& e) const override;
-
     //! Mark an Entity to be removed from the System.
     void markToRemove(Entity& e) override;
 
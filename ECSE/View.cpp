@@ -0,0 +1,115 @@
+#include "View.h"
+
+namespace ECSE
+{
+
+const size_t ViewIndex::noRow;
+
+ViewIndex::ViewIndex(const ComponentMask& mask)
+    : mask(mask), width(mask.count())
+{
+}
+
+void ViewIndex::add(Entity& e)
+{
+    if ((e.getComponentMask() & mask) != mask) return;
+
+    size_t slot = Entity::indexOf(e.getID());
+    if (slot >= rows.size())
+    {
+        rows.resize(slot + 1, noRow);
+    }
+
+    if (rows[slot] != noRow) return;
+
+    rows[slot] = entities.size();
+    entities.push_back(&e);
+
+    // Entity::getComponents is also in type ID order, so the mask's bits can be walked in step with it
+    const auto& entityComponents = e.getComponents();
+    const auto& entityMask = e.getComponentMask();
+    size_t entityIndex = 0;
+    for (size_t typeID = 0; typeID < maxComponentTypes; ++typeID)
+    {
+        if (!entityMask.test(typeID)) continue;
+
+        if (mask.test(typeID))
+        {
+            components.push_back(entityComponents[entityIndex]);
+        }
+
+        ++entityIndex;
+    }
+}
+
+void ViewIndex::remove(const Entity& e)
+{
+    size_t slot = Entity::indexOf(e.getID());
+    if (slot >= rows.size() || rows[slot] == noRow) return;
+
+    size_t row = rows[slot];
+    size_t last = entities.size() - 1;
+
+    // Swap the last row into the removed one
+    if (row != last)
+    {
+        Entity* moved = entities[last];
+        entities[row] = moved;
+        rows[Entity::indexOf(moved->getID())] = row;
+
+        for (size_t column = 0; column < width; ++column)
+        {
+            components[row * width + column] = components[last * width + column];
+        }
+    }
+
+    entities.pop_back();
+    components.resize(last * width);
+    rows[slot] = noRow;
+}
+
+bool ViewIndex::isEnabled(size_t row) const
+{
+    for (size_t column = 0; column < width; ++column)
+    {
+        if (!components[row * width + column]->enabled) return false;
+    }
+
+    return true;
+}
+
+void ViewIndexSet::add(Entity& e)
+{
+    for (auto& index : indices)
+    {
+        index->add(e);
+    }
+}
+
+void ViewIndexSet::remove(const Entity& e)
+{
+    for (auto& index : indices)
+    {
+        index->remove(e);
+    }
+}
+
+ViewIndex& ViewIndexSet::get(const ComponentMask& mask, const EntitySet& entities)
+{
+    for (auto& index : indices)
+    {
+        if (index->getMask() == mask) return *index;
+    }
+
+    indices.push_back(std::unique_ptr<ViewIndex>(new ViewIndex(mask)));
+    ViewIndex& index = *indices.back();
+
+    for (Entity* e : entities)
+    {
+        index.add(*e);
+    }
+
+    return index;
+}
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "ComponentType.h"
+#include "Entity.h"
+#include "EntitySet.h"
+
+namespace ECSE
+{
+
+//! The registered Entities which have all of a set of Component types, along with pointers to those Components.
+/*!
+* World keeps one of these for each set of types it's been asked to view and updates it as Entities are
+* registered and destroyed, so views never have to search for their Entities. Each Entity's Component
+* pointers are stored in one contiguous row, in type ID order.
+*/
+class ViewIndex
+{
+public:
+    //! Construct an empty ViewIndex.
+    /*!
+    * \param mask The Component types an Entity needs to be in the index.
+    */
+    explicit ViewIndex(const ComponentMask& mask);
+
+    //! Add an Entity if it has all the index's Component types.
+    /*!
+    * Does nothing if the Entity is already in the index.
+    *
+    * \param e The Entity.
+    */
+    void add(Entity& e);
+
+    //! Remove an Entity.
+    /*!
+    * The last row is moved into its place. Does nothing if the Entity isn't in the index.
+    *
+    * \param e The Entity.
+    */
+    void remove(const Entity& e);
+
+    //! Get the Component types an Entity needs to be in the index.
+    inline const ComponentMask& getMask() const
+    {
+        return mask;
+    }
+
+    //! Get the column a Component type's pointers are stored in.
+    /*!
+    * \param typeID The Component type ID, which must be in the mask.
+    * \return The column.
+    */
+    inline size_t getColumn(size_t typeID) const
+    {
+        return (mask << (maxComponentTypes - typeID)).count();
+    }
+
+    //! Get the number of Entities in the index.
+    inline size_t size() const
+    {
+        return entities.size();
+    }
+
+    //! Get the Entity in a row.
+    inline Entity* getEntity(size_t row) const
+    {
+        return entities[row];
+    }
+
+    //! Get a Component pointer from a row.
+    /*!
+    * \param row The row.
+    * \param column The Component type's column.
+    * \return The Component.
+    */
+    inline Component* getComponent(size_t row, size_t column) const
+    {
+        return components[row * width + column];
+    }
+
+    //! Check whether all of a row's Components are enabled.
+    /*!
+    * \param row The row.
+    * \return Whether they're all enabled.
+    */
+    bool isEnabled(size_t row) const;
+
+private:
+    //! Value in rows for an Entity which isn't in the index.
+    static const size_t noRow = static_cast<size_t>(-1);
+
+    ComponentMask mask;                 //!< The Component types an Entity needs to be in the index.
+    size_t width;                       //!< The number of Component types.
+    std::vector<Entity*> entities;      //!< The Entity in each row.
+    std::vector<Component*> components; //!< The Component pointers of each row, one after another.
+    std::vector<size_t> rows;           //!< The row of each Entity, indexed by the Entity's slot index.
+};
+
+//! ViewIndices for one group of Entities, such as a System's, with one index for each set of viewed Component types.
+/*!
+* Indices are only made once something views their types, and are then kept up to date as Entities are
+* added and removed. Rows are added in the group's order and removed by swapping the last one in, just
+* like EntitySet does, so while every Entity has the viewed types the rows are in the same order as the set.
+*/
+class ViewIndexSet
+{
+public:
+    //! Add an Entity to every index whose types it has.
+    /*!
+    * \param e The Entity.
+    */
+    void add(Entity& e);
+
+    //! Remove an Entity from every index.
+    /*!
+    * \param e The Entity.
+    */
+    void remove(const Entity& e);
+
+    //! Get the index for a set of Component types, creating it if needed.
+    /*!
+    * \param mask The Component types.
+    * \param entities The group's current Entities, which a new index starts with.
+    * \return The index.
+    */
+    ViewIndex& get(const ComponentMask& mask, const EntitySet& entities);
+
+private:
+    std::vector<std::unique_ptr<ViewIndex>> indices;    //!< The index for each set of viewed Component types.
+};
+
+//! A range over the registered Entities which have all of a set of Component types.
+/*!
+* Get one with World::view, or SetSystem::view or RenderSystem::view for just a System's own Entities.
+* Iterating it yields a std::tuple of references to each Entity's Components, in the order the types were
+* given. Entities with any of those Components disabled are skipped, unless the View came from
+* includingDisabled.
+*
+* The range is only valid until Entities are next added to or removed from the World's views, which
+* happens in World::update.
+*/
+template <typename... ComponentTypes>
+class View
+{
+public:
+    static_assert(sizeof...(ComponentTypes) > 0, "A View needs at least one Component type!");
+
+    //! Iterates the rows of a View.
+    class Iterator
+    {
+    public:
+        //! Construct the Iterator.
+        /*!
+        * \param view The View being iterated.
+        * \param row The first row, which is skipped if it's disabled.
+        */
+        Iterator(const View& view, size_t row) : view(&view), row(row)
+        {
+            skipDisabled();
+        }
+
+        //! Get references to the current Entity's Components.
+        inline std::tuple<ComponentTypes&...> operator*() const
+        {
+            return get(std::index_sequence_for<ComponentTypes...>());
+        }
+
+        //! Move to the next Entity with all its Components enabled.
+        inline Iterator& operator++()
+        {
+            ++row;
+            skipDisabled();
+            return *this;
+        }
+
+        inline bool operator==(const Iterator& other) const
+        {
+            return row == other.row;
+        }
+
+        inline bool operator!=(const Iterator& other) const
+        {
+            return row != other.row;
+        }
+
+        //! Get the current Entity.
+        inline Entity& getEntity() const
+        {
+            return *view->index.getEntity(row);
+        }
+
+    private:
+        //! Get references to the current Entity's Components.
+        template <size_t... Indices>
+        inline std::tuple<ComponentTypes&...> get(std::index_sequence<Indices...>) const
+        {
+            return std::tuple<ComponentTypes&...>(
+                static_cast<ComponentTypes&>(*view->index.getComponent(row, view->columns[Indices]))...);
+        }
+
+        //! Skip rows with any Components disabled, if the View only has enabled ones.
+        inline void skipDisabled()
+        {
+            while (view->enabledOnly && row < view->index.size() && !view->index.isEnabled(row))
+            {
+                ++row;
+            }
+        }
+
+        const View* view;   //!< The View being iterated.
+        size_t row;         //!< The current row.
+    };
+
+    //! Construct the View.
+    /*!
+    * \param index The index of Entities to view, whose mask must contain all of ComponentTypes.
+    * \param enabledOnly Whether to skip Entities with any of the Components disabled.
+    */
+    explicit View(const ViewIndex& index, bool enabledOnly = true)
+        : index(index), columns{ index.getColumn(ComponentTypeRegistry::getID<ComponentTypes>())... },
+          enabledOnly(enabledOnly)
+    {
+    }
+
+    //! Get a View of the same Entities which doesn't skip those with disabled Components.
+    /*!
+    * Every row is then visited in order, so the position in the iteration is the row in the index.
+    */
+    inline View includingDisabled() const
+    {
+        return View(index, false);
+    }
+
+    //! Get an Iterator to the first Entity.
+    inline Iterator begin() const
+    {
+        return Iterator(*this, 0);
+    }
+
+    //! Get an Iterator past the last Entity.
+    inline Iterator end() const
+    {
+        return Iterator(*this, index.size());
+    }
+
+    //! Get the number of Entities, including those with disabled Components.
+    inline size_t size() const
+    {
+        return index.size();
+    }
+
+private:
+    const ViewIndex& index;                         //!< The index of Entities being viewed.
+    size_t columns[sizeof...(ComponentTypes)];      //!< The column of each Component type in the index.
+    bool enabledOnly;                               //!< Whether Entities with disabled Components are skipped.
+};
+
+}
@@ -0,0 +1,110 @@
+#include "WorkerPool.h"
+
+namespace ECSE
+{
+
+WorkerPool::WorkerPool(size_t workerCount)
+{
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        workers.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    batchReady.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& newJob)
+{
+    if (count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &newJob;
+        jobCount = count;
+        nextJob = 0;
+        unfinishedJobs = count;
+        error = nullptr;
+        ++batch;
+    }
+    batchReady.notify_all();
+
+    runJobs();
+
+    // Wait for the workers to leave the batch too, so none of them can see the next one half set up
+    std::unique_lock<std::mutex> lock(mutex);
+    batchDone.wait(lock, [this] { return unfinishedJobs == 0 && activeWorkers == 0; });
+    job = nullptr;
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::workerLoop()
+{
+    unsigned lastBatch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            batchReady.wait(lock, [this, lastBatch] { return stopping || batch != lastBatch; });
+
+            if (stopping) return;
+            lastBatch = batch;
+
+            // The batch may have finished before this worker woke up
+            if (job == nullptr) continue;
+            ++activeWorkers;
+        }
+
+        runJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+        }
+        batchDone.notify_all();
+    }
+}
+
+void WorkerPool::runJobs()
+{
+    while (true)
+    {
+        size_t index = nextJob++;
+        if (index >= jobCount) return;
+
+        try
+        {
+            (*job)(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+        }
+
+        if (--unfinishedJobs == 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batchDone.notify_all();
+        }
+    }
+}
+
+}
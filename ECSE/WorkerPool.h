@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+namespace ECSE
+{
+
+//! A fixed set of worker threads which run batches of independent jobs.
+/*!
+* The thread which calls run also works on the batch, so a pool with no workers simply runs
+* every job in order on the calling thread.
+*/
+class WorkerPool
+{
+public:
+    //! Construct the WorkerPool.
+    /*!
+    * \param workerCount The number of threads to start, not counting the calling thread.
+    */
+    explicit WorkerPool(size_t workerCount);
+
+    //! Destroy the WorkerPool, waiting for the workers to finish.
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    //! Run a job for each index in [0, count) and wait for them all to finish.
+    /*!
+    * Jobs may run in any order and on any thread. If any job throws, the first exception is
+    * rethrown once every job has finished.
+    *
+    * \param count The number of jobs.
+    * \param job The function to call with each index.
+    */
+    void run(size_t count, const std::function<void(size_t)>& job);
+
+    //! Get the number of worker threads.
+    /*!
+    * \return The number of threads, not counting the calling thread.
+    */
+    inline size_t getWorkerCount() const
+    {
+        return workers.size();
+    }
+
+private:
+    //! The loop run by each worker thread.
+    void workerLoop();
+
+    //! Run jobs from the current batch until there are none left.
+    void runJobs();
+
+    std::vector<std::thread> workers;           //!< The worker threads.
+    std::mutex mutex;                           //!< Guards everything below which isn't atomic.
+    std::condition_variable batchReady;         //!< Signalled when a new batch starts or the pool is stopping.
+    std::condition_variable batchDone;          //!< Signalled when the last job of a batch finishes.
+
+    const std::function<void(size_t)>* job = nullptr;   //!< The job for the current batch.
+    size_t jobCount = 0;                                //!< The number of jobs in the current batch.
+    std::atomic<size_t> nextJob{0};                     //!< The index of the next job to start.
+    std::atomic<size_t> unfinishedJobs{0};              //!< The number of jobs which haven't finished.
+    size_t activeWorkers = 0;                           //!< The number of workers working on the current batch.
+    unsigned batch = 0;                                 //!< Incremented for each new batch.
+    bool stopping = false;                              //!< Whether the workers should exit.
+    std::exception_ptr error;                           //!< The first exception thrown by a job in this batch.
+};
+
+}
@@ -38,25 +38,21 @@ void World::update(sf::Time deltaTime)
         system->addAndRemove();
     }
 
-    for (auto eId : toDestroy)
-    {
-        Entity* e = EntityManager::getEntity(eId);
-
-        // Move components into a set so duplicate components don't get destroyed twice
-        // (which happens if a component was added polymorphically)
-        std::set<Component*> componentsToDestroy;
-        for (const auto& pair : e->getComponents())
-        {
-            componentsToDestroy.insert(pair.second);
-        }
+    addToViews();
 
-        for (auto* component : componentsToDestroy)
+    // Destroy the whole batch together, so each pool only has to take its memory back once
+    for (Entity* e : toDestroy)
+    {
+        for (auto& index : viewIndices)
         {
-            destroyComponent(component);
+            index->remove(*e);
         }
 
-        EntityManager::destroyEntity(eId);
+        queueDestroyComponents(*e);
     }
+
+    destroyQueuedComponents();
+    EntityManager::destroyEntities(toDestroy);
     toDestroy.clear();
 }
 
@@ -78,27 +74,18 @@ void World::render(float alpha, sf::RenderTarget& renderTarget)
 
 Entity* World::getEntity(Entity::ID id)
 {
-    if (toDestroy.empty()) return EntityManager::getEntity(id);
-    if (toDestroy.find(id) != toDestroy.end()) return nullptr;
+    Entity* e = EntityManager::getEntity(id);
+    if (e && e->destroying) return nullptr;
 
-    return EntityManager::getEntity(id);
+    return e;
 }
 
-const std::vector<Entity*> World::getEntities() const
+EntityRange World::getEntities() const
 {
-    auto entities = EntityManager::getEntities();
-    if (toDestroy.empty()) return entities;
-
-    auto validEntities = EntityManager::getEntities();
+    // Each pending Entity is only in toDestroy once, since destroyEntity won't find it again
+    const auto& entities = EntityManager::getEntities();
 
-    for (auto ent : entities)
-    {
-        if (toDestroy.find(ent->getID()) != toDestroy.end()) continue;
-
-        validEntities.push_back(ent);
-    }
-
-    return validEntities;
+    return EntityRange(entities, entities.size() - toDestroy.size());
 }
 
 Entity* World::registerEntity(Entity::ID id)
@@ -119,16 +106,72 @@ Entity* World::registerEntity(Entity::ID id)
         throw std::runtime_error(ss.str());
     }
 
-    for (auto& pair : systems)
+    // Components may move when they're stored, so this has to happen before Systems see them
+    storeComponents(*entity);
+
+    // Only Systems whose signature matches need to look at the Entity
+    const ComponentMask& mask = entity->getComponentMask();
+    for (System* system : orderedSystems)
     {
-        pair.second->inspectEntity(*entity);
+        if (system->matchesSignature(mask))
+        {
+            system->inspectEntity(*entity);
+        }
     }
 
     entity->registered = true;
 
+    if (!viewIndices.empty())
+    {
+        toAddToViews.push_back(entity);
+    }
+
     return entity;
 }
 
+void World::registerEntities(const std::vector<Entity::ID>& ids)
+{
+    std::vector<System*> matchingSystems;
+    ComponentMask matchedMask;
+    bool matched = false;
+
+    for (Entity::ID id : ids)
+    {
+        Entity* entity = EntityManager::getEntity(id);
+
+        storeComponents(*entity);
+
+        // A batch usually shares one set of Component types, so the matching Systems can be reused
+        const ComponentMask& mask = entity->getComponentMask();
+        if (!matched || mask != matchedMask)
+        {
+            matchingSystems.clear();
+            for (System* system : orderedSystems)
+            {
+                if (system->matchesSignature(mask))
+                {
+                    matchingSystems.push_back(system);
+                }
+            }
+
+            matchedMask = mask;
+            matched = true;
+        }
+
+        for (System* system : matchingSystems)
+        {
+            system->inspectEntity(*entity);
+        }
+
+        entity->registered = true;
+
+        if (!viewIndices.empty())
+        {
+            toAddToViews.push_back(entity);
+        }
+    }
+}
+
 void World::destroyEntity(Entity::ID id)
 {
     Entity* e = getEntity(id);
@@ -141,9 +184,9 @@ void World::destroyEntity(Entity::ID id)
     }
 
     // Disable all components
-    for (const auto& pair : e->getComponents())
+    for (auto* component : e->getComponents())
     {
-        pair.second->enabled = false;
+        component->enabled = false;
     }
 
     for (auto system : orderedSystems)
@@ -154,7 +197,8 @@ void World::destroyEntity(Entity::ID id)
         }
     }
 
-    toDestroy.insert(id);
+    e->destroying = true;
+    toDestroy.push_back(e);
 }
 
 int World::getSystemCount()
@@ -167,4 +211,39 @@ Engine* World::getEngine() const
     return worldState->getEngine();
 }
 
+ViewIndex& World::getViewIndex(const ComponentMask& mask)
+{
+    for (auto& index : viewIndices)
+    {
+        if (index->getMask() == mask) return *index;
+    }
+
+    viewIndices.push_back(std::unique_ptr<ViewIndex>(new ViewIndex(mask)));
+    ViewIndex& index = *viewIndices.back();
+
+    // Entities registered from here on are added in update, so only the existing ones need finding
+    for (Entity* e : EntityManager::getEntities())
+    {
+        if (e->registered)
+        {
+            index.add(*e);
+        }
+    }
+
+    return index;
+}
+
+void World::addToViews()
+{
+    for (Entity* e : toAddToViews)
+    {
+        for (auto& index : viewIndices)
+        {
+            index->add(*e);
+        }
+    }
+
+    toAddToViews.clear();
+}
+
 }
@@ -4,9 +4,13 @@
 #include <boost/unordered_map.hpp>
 #include <SFML/Graphics.hpp>
 #include <sstream>
+#include <tuple>
+#include <utility>
 #include "ComponentManager.h"
 #include "EntityManager.h"
+#include "EntityRange.h"
 #include "System.h"
+#include "View.h"
 
 namespace ECSE
 {
@@ -52,11 +56,14 @@ public:
     */
     virtual Entity* getEntity(Entity::ID id) override;
 
-    //! Get a vector of all the Entities.
+    //! Get all the Entities which aren't waiting to be destroyed.
     /*!
-    * \return A vector of all Entities.
+    * Nothing is copied. Entities marked with destroyEntity are skipped as the range is iterated.
+    * Use EntityManager::getEntities to include them.
+    *
+    * \return A range over the Entities, which is only valid until an Entity is next created or destroyed.
     */
-    virtual const std::vector<Entity*> getEntities() const override;
+    EntityRange getEntities() const;
 
     //! Destroy an Entity, removing it from the simulation.
     /*!
@@ -75,8 +82,53 @@ public:
     */
     virtual Entity* registerEntity(Entity::ID id);
 
+    //! Create many Entities without any Components or registering them.
+    /*!
+    * Declared again here so the templates below don't hide it, which would make world.createEntities(count)
+    * create and register Entities while the same call through an EntityManager didn't register them.
+    */
+    using EntityManager::createEntities;
+
+    //! Create and register many Entities with the same Component types.
+    /*!
+    * This is much faster than creating, attaching and registering them one at a time. IDs and Component
+    * memory are reserved for the whole batch first, so the Entities and each type's Components are
+    * allocated together, and the Systems the Entities belong in are only found once.
+    *
+    * For example, to spawn 100 bullets:
+    *
+    *     world.createEntities<TransformComponent, CircleColliderComponent>(100,
+    *         [&](Entity& e, TransformComponent& transform, CircleColliderComponent& collider)
+    *     {
+    *         collider.radius = 2.f;
+    *     });
+    *
+    * \tparam ComponentTypes The Component types to attach to each Entity, of which there must be at least
+    *                        one. Base types given by ExtendsComponent are attached too.
+    * \param count The number of Entities.
+    * \param init Called as init(Entity&, ComponentTypes&...) for each Entity before it's registered,
+    *             to set up its Components.
+    * \return The IDs of the new Entities, in the order they were created.
+    */
+    template <typename... ComponentTypes, typename Function>
+    std::vector<Entity::ID> createEntities(size_t count, Function init);
+
+    //! Create and register many Entities with the same Component types, leaving the Components as constructed.
+    /*!
+    * \tparam ComponentTypes The Component types to attach to each Entity.
+    * \param count The number of Entities.
+    * \return The IDs of the new Entities, in the order they were created.
+    * \see createEntities(size_t, Function)
+    */
+    template <typename... ComponentTypes>
+    std::vector<Entity::ID> createEntities(size_t count);
+
     //! Attach a Component to an Entity.
     /*!
+    * With ComponentManager::ARCHETYPE_STORAGE, the Component is moved when the Entity is registered,
+    * so the returned pointer (and any pointer the Component keeps to itself) is only valid until then.
+    * Use Entity::getComponent to get it again afterward.
+    *
     * \tparam ComponentType The type of the component to add. Must be a descendant of Component.
     * \param id The ID of the Entity.
     * \return A pointer to the Component.
@@ -86,13 +138,39 @@ public:
 
     //! Attach a Component to an Entity.
     /*!
+    * The returned pointer is only valid until the Entity is registered when Components are stored by archetype.
+    *
     * \tparam ComponentType The type of the component to add. Must be a descendant of Component.
     * \param entity A reference to the Entity.
     * \return A pointer to the Component.
+    * \see attachComponent(Entity::ID)
     */
     template <typename ComponentType>
     ComponentType* attachComponent(Entity& entity);
 
+    //! Get a range over the registered Entities which have all of the given Component types.
+    /*!
+    * Iterating the View yields a std::tuple of references to each Entity's Components, skipping
+    * Entities with any of them disabled. For example:
+    *
+    *     for (auto components : world.view<TransformComponent, CircleColliderComponent>())
+    *     {
+    *         auto& transform = std::get<0>(components);
+    *     }
+    *
+    * The Entities matching each set of types are tracked from the first call onward, and kept up to
+    * date as Entities are registered and destroyed. Like a System's Entities, they're added and removed
+    * in update(), so the View should be iterated right away rather than kept.
+    *
+    * A View has every registered Entity with the types, whichever Systems accepted it, so a System
+    * which only works on its own Entities should use SetSystem::view instead.
+    *
+    * \tparam ComponentTypes The Component types. Base types given by ExtendsComponent also match.
+    * \return The View.
+    */
+    template <typename... ComponentTypes>
+    View<ComponentTypes...> view();
+
     //! Add a System of this type to the World.
     /*!
     * Note that the order in which Systems are added also determines the order in which they are updated.
@@ -136,24 +214,42 @@ protected:
     WorldState* worldState = nullptr;   //!< The WorldState to which this belongs.
 
 private:
-    //! Attach a Component to an Entity.
+    //! Attach a Component to an Entity, and also as its base types if it has any.
     /*!
     * \tparam ComponentType The type of the component to add. Must be a descendant of Component.
-    * \param id The ID of the Entity.
+    * \param entity The Entity, which mustn't be registered yet.
     * \return A pointer to the Component.
     */
     template <typename ComponentType>
-    ComponentType* internalAttachComponent(Entity::ID id);
+    ComponentType* internalAttachComponent(Entity& entity);
 
     //! Attach a Component to an Entity, marking it also as its base type.
     /*!
     * \tparam ComponentType The type of the component to add. Must be a descendant of Component.
     * \tparam BaseType The Component type from which ComponentType descends. Must be a descendant of Component.
-    * \param id The ID of the Entity.
+    * \param entity The Entity, which mustn't be registered yet.
     * \return A pointer to the Component.
     */
     template <typename ComponentType, typename BaseType>
-    ComponentType* internalAttachComponent(Entity::ID id);
+    ComponentType* internalAttachComponent(Entity& entity);
+
+    //! Call a function with an Entity and references to its Components.
+    /*!
+    * \param fn The function, called as fn(Entity&, ComponentTypes&...).
+    * \param entity The Entity.
+    * \param components Pointers to the Components.
+    */
+    template <typename Function, typename... ComponentTypes, size_t... Indices>
+    static void callWithComponents(Function& fn, Entity& entity, const std::tuple<ComponentTypes*...>& components,
+                                   std::index_sequence<Indices...>);
+
+    //! Register a batch of new Entities with the Systems.
+    /*!
+    * The Systems are only matched again when an Entity's Component types differ from the previous one's.
+    *
+    * \param ids The IDs of the Entities, none of which may be registered yet.
+    */
+    void registerEntities(const std::vector<Entity::ID>& ids);
 
     //! Recursively attach the same component as its base types.
     /*!
@@ -164,11 +260,23 @@ private:
     template <typename ComponentType>
     void recursivelyAttachComponent(Entity& entity, Component& component);
 
+    //! Get the index of Entities for a set of Component types, making it if it doesn't exist.
+    /*!
+    * \param mask The Component types.
+    * \return The index.
+    */
+    ViewIndex& getViewIndex(const ComponentMask& mask);
+
+    //! Add the Entities registered since the last update to the view indices.
+    void addToViews();
+
     // Use a boost unordered map because MSVC's STL unordered map is slower than molasses on a cold winter's day.
     boost::unordered_map<size_t, std::unique_ptr<System>> systems;  //!< Map from System type hash code to the System itself.
     std::vector<System*> orderedSystems;                            //!< Vector of Systems in preferred call order.
     bool systemsAdded = false;                                      //!< Whether Systems are finished being added.
-    std::set<Entity::ID> toDestroy;                                 //!< Entities to be destroyed at the end of the advance step.
+    std::vector<Entity*> toDestroy;                                 //!< Entities to be destroyed at the end of the advance step.
+    std::vector<std::unique_ptr<ViewIndex>> viewIndices;           //!< Indices of Entities for each set of viewed Component types.
+    std::vector<Entity*> toAddToViews;                              //!< Entities registered since the view indices were last updated.
 };
 
 /////////////////
@@ -179,13 +287,23 @@ ComponentType* World::attachComponent(Entity::ID id)
 {
     Entity* entity = getEntity(id);
 
-    // This component extends another type, so we need to add it as both types
-    if (!std::is_same<typename ComponentType::ExtendsComponent, Component>::value)
+    if (!entity)
+    {
+        std::stringstream ss;
+        ss << "Tried to attach a Component to an Entity with an invalid id (#" << id << ")";
+
+        throw std::runtime_error(ss.str());
+    }
+
+    if (entity->registered)
     {
-        return internalAttachComponent<ComponentType, typename ComponentType::ExtendsComponent>(id);
+        std::stringstream ss;
+        ss << "Tried to attach a Component to an Entity which has already been registered (#" << id << ")";
+
+        throw std::runtime_error(ss.str());
     }
 
-    return internalAttachComponent<ComponentType>(id);
+    return internalAttachComponent<ComponentType>(*entity);
 }
 
 template <typename ComponentType>
@@ -194,44 +312,68 @@ ComponentType* World::attachComponent(Entity& entity)
     return attachComponent<ComponentType>(entity.getID());
 }
 
-template <typename ComponentType>
-ComponentType* World::internalAttachComponent(Entity::ID id)
+template <typename... ComponentTypes, typename Function>
+std::vector<Entity::ID> World::createEntities(size_t count, Function init)
 {
-    Entity* entity = getEntity(id);
+    static_assert(sizeof...(ComponentTypes) > 0, "createEntities needs at least one Component type!");
 
-    if (!entity)
+    std::vector<Entity::ID> ids = EntityManager::createEntities(count);
+    reserveComponents<ComponentTypes...>(count);
+
+    for (Entity::ID id : ids)
     {
-        std::stringstream ss;
-        ss << "Tried to attach a Component to an Entity with an invalid id (#" << id << ")";
+        // The Entities are brand new, so they can skip the checks attachComponent makes.
+        // Brace initialization attaches the types in order, so each pool is allocated from in the same order.
+        Entity& entity = *EntityManager::getEntity(id);
+        std::tuple<ComponentTypes*...> components{ internalAttachComponent<ComponentTypes>(entity)... };
 
-        throw std::runtime_error(ss.str());
+        callWithComponents(init, entity, components, std::index_sequence_for<ComponentTypes...>());
     }
 
-    if (entity->registered)
-    {
-        std::stringstream ss;
-        ss << "Tried to attach a Component to an Entity which has already been registered (#" << id << ")";
+    registerEntities(ids);
 
-        throw std::runtime_error(ss.str());
+    return ids;
+}
+
+template <typename Function, typename... ComponentTypes, size_t... Indices>
+void World::callWithComponents(Function& fn, Entity& entity, const std::tuple<ComponentTypes*...>& components,
+                               std::index_sequence<Indices...>)
+{
+    fn(entity, *std::get<Indices>(components)...);
+}
+
+template <typename... ComponentTypes>
+std::vector<Entity::ID> World::createEntities(size_t count)
+{
+    return createEntities<ComponentTypes...>(count, [](Entity&, ComponentTypes&...) {});
+}
+
+template <typename ComponentType>
+ComponentType* World::internalAttachComponent(Entity& entity)
+{
+    // This component extends another type, so we need to add it as both types
+    if (!std::is_same<typename ComponentType::ExtendsComponent, Component>::value)
+    {
+        return internalAttachComponent<ComponentType, typename ComponentType::ExtendsComponent>(entity);
     }
 
     ComponentType* component = createComponent<ComponentType>();
-    entity->attachComponent(component);
+    entity.attachComponent(component);
 
     return component;
 }
 
 template <typename ComponentType, typename BaseType>
-ComponentType* World::internalAttachComponent(Entity::ID id)
+ComponentType* World::internalAttachComponent(Entity& entity)
 {
     static_assert(std::is_base_of<BaseType, ComponentType>::value,
                   "ComponentType must be a descendant of BaseType!");
 
-    auto* component = internalAttachComponent<ComponentType>(id);
+    ComponentType* component = createComponent<ComponentType>();
+    entity.attachComponent(component);
 
     // Attach it again with the base type
-    Entity* entity = getEntity(id);
-    recursivelyAttachComponent<BaseType>(*entity, *component);
+    recursivelyAttachComponent<BaseType>(entity, *component);
 
     return component;
 }
@@ -249,6 +391,18 @@ void World::recursivelyAttachComponent(Entity& entity, Component& component)
     recursivelyAttachComponent<typename ComponentType::ExtendsComponent>(entity, component);
 }
 
+template <typename... ComponentTypes>
+View<ComponentTypes...> World::view()
+{
+    ComponentMask mask;
+    for (size_t typeID : { ComponentTypeRegistry::getID<ComponentTypes>()... })
+    {
+        mask.set(typeID);
+    }
+
+    return View<ComponentTypes...>(getViewIndex(mask));
+}
+
 template <typename SystemType>
 SystemType* World::addSystem()
 {
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "ECSE/BatchCollisionMath.h"
+#include "ECSE/CollisionMath.h"
+#include <random>
+
+//! Check a batch result against the scalar result.
+static void expectMatch(float expectedTime, sf::Vector2f expectedNormal, float time, sf::Vector2f normal)
+{
+    if (expectedTime < 0.f)
+    {
+        EXPECT_LT(time, 0.f);
+        return;
+    }
+
+    EXPECT_NEAR(expectedTime, time, 1e-5f);
+    EXPECT_NEAR(expectedNormal.x, normal.x, 1e-4f);
+    EXPECT_NEAR(expectedNormal.y, normal.y, 1e-4f);
+}
+
+TEST(BatchCollisionMathTest, CircleCircleMatchesScalarTest)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-50.f, 50.f);
+    std::uniform_real_distribution<float> radiusDist(0.f, 10.f);
+
+    // An odd size so that the scalar remainder is tested too
+    ECSE::CircleCircleBatch batch;
+    for (size_t i = 0; i < 1003; ++i)
+    {
+        sf::Vector2f velocity(posDist(rng), posDist(rng));
+
+        // Some collisions with no movement at all
+        if (i % 100 == 0) velocity = sf::Vector2f();
+
+        batch.add(sf::Vector2f(posDist(rng), posDist(rng)), radiusDist(rng),
+                  sf::Vector2f(posDist(rng), posDist(rng)), radiusDist(rng), velocity);
+    }
+
+    ECSE::solveBatch(batch);
+    ASSERT_EQ(batch.size(), batch.time.size());
+
+    size_t hits = 0;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        float time;
+        sf::Vector2f normal;
+        ECSE::circleCircle(sf::Vector2f(batch.centerAX[i], batch.centerAY[i]), batch.radiusA[i],
+                           sf::Vector2f(batch.centerBX[i], batch.centerBY[i]), batch.radiusB[i],
+                           sf::Vector2f(batch.velocityX[i], batch.velocityY[i]), time, normal);
+
+        expectMatch(time, normal, batch.time[i], batch.getNormal(i));
+        if (time >= 0.f) ++hits;
+    }
+
+    // Make sure both hits and misses were tested
+    ASSERT_LT(50, hits);
+    ASSERT_GT(batch.size() - 100, hits);
+}
+
+TEST(BatchCollisionMathTest, CircleLineMatchesScalarTest)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-50.f, 50.f);
+    std::uniform_real_distribution<float> radiusDist(0.f, 10.f);
+
+    ECSE::CircleLineBatch batch;
+    for (size_t i = 0; i < 1003; ++i)
+    {
+        sf::Vector2f center(posDist(rng), posDist(rng));
+        sf::Vector2f start(posDist(rng), posDist(rng));
+        sf::Vector2f end(posDist(rng), posDist(rng));
+        sf::Vector2f velocity(posDist(rng), posDist(rng));
+
+        // Moving parallel to the line, which can only hit an endpoint
+        if (i % 10 == 0) velocity = (end - start) * 0.5f;
+
+        // Axis-aligned lines
+        if (i % 10 == 1) end.x = start.x;
+        if (i % 10 == 2) end.y = start.y;
+
+        batch.add(center, radiusDist(rng), start, end, velocity);
+    }
+
+    ECSE::solveBatch(batch);
+    ASSERT_EQ(batch.size(), batch.time.size());
+
+    size_t hits = 0;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        float time;
+        sf::Vector2f normal;
+        ECSE::circleLine(sf::Vector2f(batch.centerX[i], batch.centerY[i]), batch.radius[i],
+                         sf::Vector2f(batch.startX[i], batch.startY[i]), sf::Vector2f(batch.endX[i], batch.endY[i]),
+                         sf::Vector2f(batch.velocityX[i], batch.velocityY[i]), time, normal);
+
+        expectMatch(time, normal, batch.time[i], batch.getNormal(i));
+        if (time >= 0.f) ++hits;
+    }
+
+    ASSERT_LT(100, hits);
+    ASSERT_GT(batch.size() - 100, hits);
+}
+
+TEST(BatchCollisionMathTest, ClearTest)
+{
+    ECSE::CircleCircleBatch batch;
+    batch.add(sf::Vector2f(), 1.f, sf::Vector2f(10.f, 0.f), 1.f, sf::Vector2f(20.f, 0.f));
+    ECSE::solveBatch(batch);
+    batch.clear();
+
+    ASSERT_EQ(0, batch.size());
+    ASSERT_TRUE(batch.time.empty());
+
+    ECSE::solveBatch(batch);
+    ASSERT_TRUE(batch.time.empty());
+}
@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+#include "ECSE/Broadphase.h"
+#include <algorithm>
+#include <random>
+
+//! Find overlapping pairs the slow way.
+static std::vector<ECSE::Broadphase::Pair> bruteForcePairs(const std::vector<ECSE::AABB>& bounds)
+{
+    std::vector<ECSE::Broadphase::Pair> pairs;
+
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        for (size_t j = i + 1; j < bounds.size(); ++j)
+        {
+            if (bounds[i].overlaps(bounds[j])) pairs.push_back(ECSE::Broadphase::Pair(i, j));
+        }
+    }
+
+    return pairs;
+}
+
+//! Generate a bunch of random bounds, including a few very large ones.
+static std::vector<ECSE::AABB> randomBounds(size_t count)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-500.f, 500.f);
+    std::uniform_real_distribution<float> sizeDist(1.f, 40.f);
+
+    std::vector<ECSE::AABB> bounds;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sf::Vector2f min(posDist(rng), posDist(rng));
+        float size = (i % 50 == 0) ? 800.f : sizeDist(rng);
+
+        bounds.push_back(ECSE::AABB(min, min + sf::Vector2f(size, sizeDist(rng))));
+    }
+
+    return bounds;
+}
+
+static void testMatchesBruteForce(ECSE::Broadphase& broadphase)
+{
+    auto bounds = randomBounds(500);
+
+    std::vector<ECSE::Broadphase::Pair> pairs;
+    broadphase.findPairs(bounds, pairs);
+    std::sort(pairs.begin(), pairs.end());
+
+    auto expected = bruteForcePairs(bounds);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, pairs);
+}
+
+static void testQuery(ECSE::Broadphase& broadphase)
+{
+    auto bounds = randomBounds(500);
+
+    std::vector<ECSE::Broadphase::Pair> pairs;
+    broadphase.findPairs(bounds, pairs);
+
+    ECSE::AABB queryBounds(sf::Vector2f(-50.f, -50.f), sf::Vector2f(50.f, 50.f));
+
+    std::vector<size_t> results;
+    broadphase.query(queryBounds, results);
+    std::sort(results.begin(), results.end());
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        if (bounds[i].overlaps(queryBounds)) expected.push_back(i);
+    }
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, results);
+}
+
+static void testCoherence(ECSE::Broadphase& broadphase)
+{
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> moveDist(-20.f, 20.f);
+
+    auto bounds = randomBounds(500);
+
+    // Move things a little each call, sometimes adding or removing some at the end
+    for (size_t call = 0; call < 10; ++call)
+    {
+        for (auto& b : bounds)
+        {
+            sf::Vector2f move(moveDist(rng), moveDist(rng));
+            b = ECSE::AABB(b.min + move, b.max + move);
+        }
+
+        if (call == 3) bounds.resize(450);
+        if (call == 6)
+        {
+            auto extra = randomBounds(60);
+            bounds.insert(bounds.end(), extra.begin(), extra.end());
+        }
+
+        std::vector<ECSE::Broadphase::Pair> pairs;
+        broadphase.findPairs(bounds, pairs);
+        std::sort(pairs.begin(), pairs.end());
+
+        ASSERT_EQ(bruteForcePairs(bounds), pairs);
+    }
+}
+
+TEST(AABBTest, OverlapTest)
+{
+    ECSE::AABB a(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 10.f));
+
+    ASSERT_TRUE(a.overlaps(ECSE::AABB(sf::Vector2f(5.f, 5.f), sf::Vector2f(15.f, 15.f))));
+    ASSERT_TRUE(a.overlaps(ECSE::AABB(sf::Vector2f(10.f, 0.f), sf::Vector2f(15.f, 15.f))));
+    ASSERT_FALSE(a.overlaps(ECSE::AABB(sf::Vector2f(11.f, 0.f), sf::Vector2f(15.f, 15.f))));
+    ASSERT_FALSE(a.overlaps(ECSE::AABB(sf::Vector2f(0.f, -5.f), sf::Vector2f(10.f, -1.f))));
+}
+
+TEST(AABBTest, EmptyTest)
+{
+    ECSE::AABB empty;
+    ECSE::AABB a(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 10.f));
+
+    ASSERT_FALSE(empty.overlaps(a));
+    ASSERT_FALSE(a.overlaps(empty));
+}
+
+TEST(AABBTest, IncludeTest)
+{
+    ECSE::AABB a;
+    a.include(sf::Vector2f(5.f, -3.f));
+    a.include(sf::Vector2f(-2.f, 8.f));
+    a.pad(1.f);
+
+    ASSERT_FLOAT_EQ(-3.f, a.min.x);
+    ASSERT_FLOAT_EQ(-4.f, a.min.y);
+    ASSERT_FLOAT_EQ(6.f, a.max.x);
+    ASSERT_FLOAT_EQ(9.f, a.max.y);
+}
+
+TEST(SortAndSweepBroadphaseTest, MatchesBruteForceTest)
+{
+    ECSE::SortAndSweepBroadphase broadphase;
+    testMatchesBruteForce(broadphase);
+}
+
+TEST(SortAndSweepBroadphaseTest, QueryTest)
+{
+    ECSE::SortAndSweepBroadphase broadphase;
+    testQuery(broadphase);
+}
+
+TEST(SortAndSweepBroadphaseTest, CoherenceTest)
+{
+    ECSE::SortAndSweepBroadphase broadphase;
+    testCoherence(broadphase);
+}
+
+TEST(UniformGridBroadphaseTest, MatchesBruteForceTest)
+{
+    ECSE::UniformGridBroadphase broadphase(32.f);
+    testMatchesBruteForce(broadphase);
+}
+
+TEST(UniformGridBroadphaseTest, QueryTest)
+{
+    ECSE::UniformGridBroadphase broadphase(32.f);
+    testQuery(broadphase);
+}
+
+TEST(UniformGridBroadphaseTest, CoherenceTest)
+{
+    ECSE::UniformGridBroadphase broadphase(32.f);
+    testCoherence(broadphase);
+}
+
+TEST(UniformGridBroadphaseTest, NoDuplicatePairsTest)
+{
+    ECSE::UniformGridBroadphase broadphase(1.f);
+
+    // These share many cells
+    std::vector<ECSE::AABB> bounds = {
+        ECSE::AABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(5.f, 5.f)),
+        ECSE::AABB(sf::Vector2f(1.f, 1.f), sf::Vector2f(6.f, 6.f))
+    };
+
+    std::vector<ECSE::Broadphase::Pair> pairs;
+    broadphase.findPairs(bounds, pairs);
+
+    ASSERT_EQ(1, pairs.size());
+}
+
+TEST(UniformGridBroadphaseTest, InvalidCellSizeTest)
+{
+    ASSERT_THROW(ECSE::UniformGridBroadphase(0.f), std::runtime_error);
+}
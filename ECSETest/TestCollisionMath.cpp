@@ -445,3 +445,49 @@ TEST(CircleLineTest, MoveAwayEndpointTest)
     ASSERT_LT(normal.x, 0.f);
     ASSERT_GT(normal.y, 0.f);
 }
+
+TEST(RaycastTest, AABBHitTest)
+{
+    ECSE::AABB bounds(sf::Vector2f(10.f, -5.f), sf::Vector2f(20.f, 5.f));
+
+    ASSERT_FLOAT_EQ(0.25f, ECSE::raycastAABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(40.f, 0.f), bounds));
+    ASSERT_FLOAT_EQ(0.f, ECSE::raycastAABB(sf::Vector2f(15.f, 0.f), sf::Vector2f(40.f, 0.f), bounds));
+    ASSERT_LT(ECSE::raycastAABB(sf::Vector2f(0.f, 10.f), sf::Vector2f(40.f, 10.f), bounds), 0.f);
+    ASSERT_LT(ECSE::raycastAABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(5.f, 0.f), bounds), 0.f);
+}
+
+TEST(RaycastTest, CircleHitTest)
+{
+    sf::Vector2f normal;
+    float time = ECSE::raycastCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(20.f, 0.f),
+                                     sf::Vector2f(10.f, 0.f), 2.f, normal);
+
+    ASSERT_FLOAT_EQ(0.4f, time);
+    ASSERT_FLOAT_EQ(-1.f, normal.x);
+    ASSERT_FLOAT_EQ(0.f, normal.y);
+
+    ASSERT_LT(ECSE::raycastCircle(sf::Vector2f(0.f, 5.f), sf::Vector2f(20.f, 5.f),
+                                  sf::Vector2f(10.f, 0.f), 2.f, normal), 0.f);
+}
+
+TEST(RaycastTest, LineHitTest)
+{
+    sf::Vector2f normal;
+    float time = ECSE::raycastLine(sf::Vector2f(0.f, 0.f), sf::Vector2f(20.f, 0.f),
+                                   sf::Vector2f(5.f, -5.f), sf::Vector2f(5.f, 5.f), normal);
+
+    ASSERT_FLOAT_EQ(0.25f, time);
+    ASSERT_FLOAT_EQ(-1.f, normal.x);
+    ASSERT_FLOAT_EQ(0.f, normal.y);
+}
+
+TEST(ClosestPointTest, ClampTest)
+{
+    auto closest = ECSE::findClosestPointOnLine(sf::Vector2f(-5.f, 3.f), sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f));
+    ASSERT_FLOAT_EQ(0.f, closest.x);
+    ASSERT_FLOAT_EQ(0.f, closest.y);
+
+    closest = ECSE::findClosestPointOnLine(sf::Vector2f(5.f, 3.f), sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f));
+    ASSERT_FLOAT_EQ(5.f, closest.x);
+    ASSERT_FLOAT_EQ(0.f, closest.y);
+}
@@ -3,7 +3,12 @@
 #include "ECSE/CollisionSystem.h"
 #include "ECSE/CircleColliderComponent.h"
 #include "ECSE/LineColliderComponent.h"
+#include "ECSE/CompoundColliderComponent.h"
+#include <algorithm>
 #include <functional>
+#include <random>
+#include <sstream>
+#include <tuple>
 
 class CollisionDebugComponent : public ECSE::Component
 {
@@ -15,10 +20,8 @@ public:
         if (disableOnHit)
         {
             // Disable all colliders with some ugly RTTI
-            for (auto pair : collision.self->getComponents())
+            for (auto component : collision.self->getComponents())
             {
-                auto component = pair.second;
-
                 if (dynamic_cast<ECSE::ColliderComponent*>(component) != nullptr)
                 {
                     component->enabled = false;
@@ -84,7 +87,8 @@ public:
         return debugComponent;
     }
 
-    CollisionDebugComponent* createLine(sf::Vector2f start, sf::Vector2f end, sf::Vector2f vec, bool discrete = false, sf::Vector2f offset = sf::Vector2f())
+    CollisionDebugComponent* createLine(sf::Vector2f start, sf::Vector2f end, sf::Vector2f vec, bool discrete = false, sf::Vector2f offset = sf::Vector2f(),
+                                        bool isStatic = false)
     {
         using namespace std::placeholders;
 
@@ -95,6 +99,7 @@ public:
         auto collider = world.attachComponent<ECSE::LineColliderComponent>(id);
         collider->vec = vec;
         collider->offset = offset;
+        collider->isStatic = isStatic;
         collider->addCallback(std::bind(&CollisionDebugComponent::onCollide, debugComponent, _1));
 
         world.registerEntity(id);
@@ -132,9 +137,9 @@ TEST_F(CollisionSystemTest, CollisionDataTest)
 
     auto collision = debug->collisions[0];
 
-    auto entities = world.getEntities();
-    ECSE::Entity* entA = entities[0];
-    ECSE::Entity* entB = entities[1];
+    auto entities = world.getEntities().begin();
+    ECSE::Entity* entA = *entities++;
+    ECSE::Entity* entB = *entities;
 
     ASSERT_EQ(entA, collision.self);
     ASSERT_EQ(entB, collision.other);
@@ -373,3 +378,1129 @@ TEST_F(CollisionSystemTest, RedirectTest)
     ASSERT_FLOAT_EQ(40.f, debugA->collisions[1].position.x);
     ASSERT_FLOAT_EQ(30.f, debugA->collisions[1].position.y);
 }
+
+TEST_F(CollisionSystemTest, GridBroadphaseRedirectTest)
+{
+    system->setBroadphase(std::make_unique<ECSE::UniformGridBroadphase>(16.f));
+
+    ECSE::Entity *entA, *entB, *entC;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entA);
+    createCircle(sf::Vector2f(50.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entB);
+    createCircle(sf::Vector2f(40.f, 40.f), sf::Vector2f(40.f, 40.f), 5.f, false, sf::Vector2f(), &entC);
+
+    // Circle C is outside of circle A's original sweep, so it can only be found after the redirect
+    bool hasHit = false;
+    entA->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [&](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        if (hasHit) return { };
+
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position + sf::Vector2f(0.f, 50.f));
+
+        hasHit = true;
+
+        return { collision.self };
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(2, debugA->collisions.size());
+    ASSERT_EQ(entB, debugA->collisions[0].other);
+    ASSERT_EQ(entC, debugA->collisions[1].other);
+}
+
+TEST_F(CollisionSystemTest, ContactCallbackRedirectTest)
+{
+    ECSE::Entity *entA, *entB, *entC;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entA);
+    createCircle(sf::Vector2f(50.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entB);
+    createCircle(sf::Vector2f(40.f, 40.f), sf::Vector2f(40.f, 40.f), 5.f, false, sf::Vector2f(), &entC);
+
+    // Report the same change twice to check that duplicates are handled
+    bool hasHit = false;
+    entA->getComponent<ECSE::CircleColliderComponent>()->addContactCallback(
+        [&](const ECSE::Collision& collision, ECSE::ColliderComponent::ChangeList& changes)
+    {
+        if (hasHit) return;
+
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position + sf::Vector2f(0.f, 50.f));
+
+        hasHit = true;
+
+        changes.push_back(collision.self);
+        changes.push_back(collision.self);
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(2, debugA->collisions.size());
+    ASSERT_EQ(entB, debugA->collisions[0].other);
+    ASSERT_EQ(entC, debugA->collisions[1].other);
+    ASSERT_FLOAT_EQ(30.f, debugA->collisions[1].position.y);
+
+    // Both collisions are in the step's contacts, whichever Entity's point of view they're from
+    auto& contacts = system->getContacts();
+    ASSERT_EQ(2, contacts.size());
+    ASSERT_TRUE(contacts[0].self == entA || contacts[0].other == entA);
+    ASSERT_TRUE(contacts[0].self == entB || contacts[0].other == entB);
+    ASSERT_TRUE(contacts[1].self == entC || contacts[1].other == entC);
+    ASSERT_LE(contacts[0].time, contacts[1].time);
+
+    // The buffer only holds the last step
+    world.update(sf::Time::Zero);
+    world.advance();
+    ASSERT_EQ(debugA->collisions.size() - 2, system->getContacts().size());
+}
+
+TEST_F(CollisionSystemTest, BroadphasePairCountTest)
+{
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(12.f, 0.f), sf::Vector2f(12.f, 0.f), 3.f);
+
+    // Far away from everything else
+    createCircle(sf::Vector2f(500.f, 500.f), sf::Vector2f(510.f, 500.f), 3.f);
+    createCircle(sf::Vector2f(-500.f, 500.f), sf::Vector2f(-500.f, 510.f), 3.f);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, system->getPairCount());
+}
+
+TEST_F(CollisionSystemTest, StaticLineHitTest)
+{
+    auto debugA = createCircle(sf::Vector2f(20.f, 0.f), sf::Vector2f(20.f, 40.f), 3.f);
+    auto debugB = createLine(sf::Vector2f(0.f, 20.f), sf::Vector2f(0.f, 20.f), sf::Vector2f(100.f, 0.f), false, sf::Vector2f(), true);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, system->getStaticCount());
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+    ASSERT_FLOAT_EQ(17.f, debugA->collisions[0].position.y);
+}
+
+TEST_F(CollisionSystemTest, StaticLineRedirectTest)
+{
+    ECSE::Entity* entA;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entA);
+
+    // A wall in the way, and another wall which circle A can only reach after being redirected
+    createLine(sf::Vector2f(50.f, -20.f), sf::Vector2f(50.f, -20.f), sf::Vector2f(0.f, 40.f), false, sf::Vector2f(), true);
+    createLine(sf::Vector2f(0.f, 40.f), sf::Vector2f(0.f, 40.f), sf::Vector2f(100.f, 0.f), false, sf::Vector2f(), true);
+
+    bool hasHit = false;
+    entA->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [&](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        if (hasHit) return { };
+
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position + sf::Vector2f(0.f, 50.f));
+
+        hasHit = true;
+
+        return { collision.self };
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(2, debugA->collisions.size());
+    ASSERT_FLOAT_EQ(45.f, debugA->collisions[1].position.x);
+    ASSERT_FLOAT_EQ(35.f, debugA->collisions[1].position.y);
+}
+
+TEST_F(CollisionSystemTest, StaticStaticPairTest)
+{
+    // These overlap, but static colliders are never checked against each other
+    auto debugA = createLine(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), sf::Vector2f(100.f, 0.f), false, sf::Vector2f(), true);
+    auto debugB = createLine(sf::Vector2f(50.f, -50.f), sf::Vector2f(50.f, -50.f), sf::Vector2f(0.f, 100.f), false, sf::Vector2f(), true);
+
+    // Moves near the static lines without touching them
+    createCircle(sf::Vector2f(200.f, 0.f), sf::Vector2f(210.f, 0.f), 3.f);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(2, system->getStaticCount());
+    ASSERT_EQ(0, system->getPairCount());
+    ASSERT_EQ(0, debugA->collisions.size());
+    ASSERT_EQ(0, debugB->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, SimultaneousImpactTest)
+{
+    ECSE::Entity* entA;
+
+    // A hits B and is redirected at the same time as C hits D
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 1.f, false, sf::Vector2f(), &entA);
+    auto debugB = createCircle(sf::Vector2f(6.f, 0.f), sf::Vector2f(6.f, 0.f), 1.f);
+    auto debugC = createCircle(sf::Vector2f(0.f, 100.f), sf::Vector2f(10.f, 100.f), 1.f);
+    auto debugD = createCircle(sf::Vector2f(6.f, 100.f), sf::Vector2f(6.f, 100.f), 1.f);
+
+    entA->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [&](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position + sf::Vector2f(0.f, -20.f));
+
+        return { collision.self };
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    // Each impact is only reported once, even though something else changed at the same time
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+    ASSERT_EQ(1, debugC->collisions.size());
+    ASSERT_EQ(1, debugD->collisions.size());
+    ASSERT_FLOAT_EQ(debugA->collisions[0].time, debugC->collisions[0].time);
+}
+
+TEST_F(CollisionSystemTest, ChainedBounceTest)
+{
+    ECSE::Entity* entA;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(98.f, 0.f), 1.f, false, sf::Vector2f(), &entA);
+
+    // Walls on either side, 8 units of travel apart
+    createLine(sf::Vector2f(-5.f, -50.f), sf::Vector2f(-5.f, -50.f), sf::Vector2f(0.f, 100.f), false, sf::Vector2f(), true);
+    createLine(sf::Vector2f(5.f, -50.f), sf::Vector2f(5.f, -50.f), sf::Vector2f(0.f, 100.f), false, sf::Vector2f(), true);
+
+    // Reflect the rest of the movement off each wall
+    entA->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [&](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        auto next = tc->getNextLocalPosition();
+        next.x = 2.f * collision.position.x - next.x;
+
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(next);
+
+        return { collision.self };
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    // Hits after 4 units of travel, then every 8 units
+    ASSERT_EQ(12, debugA->collisions.size());
+
+    for (size_t i = 1; i < debugA->collisions.size(); ++i)
+    {
+        ASSERT_LT(debugA->collisions[i - 1].time, debugA->collisions[i].time);
+    }
+}
+
+TEST_F(CollisionSystemTest, IslandCountTest)
+{
+    // Two pairs which are far apart from each other, plus a circle which doesn't hit anything
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(12.f, 0.f), sf::Vector2f(12.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(0.f, 100.f), sf::Vector2f(10.f, 100.f), 3.f);
+    createCircle(sf::Vector2f(12.f, 100.f), sf::Vector2f(12.f, 100.f), 3.f);
+    createCircle(sf::Vector2f(500.f, 500.f), sf::Vector2f(510.f, 500.f), 3.f);
+
+    // A static wall touching both pairs, with no callbacks to change anything
+    ECSE::Entity::ID id = createMovingEntity(world, sf::Vector2f(6.f, -50.f), sf::Vector2f(6.f, -50.f));
+    auto collider = world.attachComponent<ECSE::LineColliderComponent>(id);
+    collider->vec = sf::Vector2f(0.f, 200.f);
+    collider->isStatic = true;
+    world.registerEntity(id);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(2, system->getIslandCount());
+}
+
+TEST_F(CollisionSystemTest, StaticCallbackIslandTest)
+{
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(0.f, 100.f), sf::Vector2f(10.f, 100.f), 3.f);
+
+    // This wall's callbacks could be called from either circle's island, so they have to be solved together
+    auto debugWall = createLine(sf::Vector2f(6.f, -50.f), sf::Vector2f(6.f, -50.f), sf::Vector2f(0.f, 200.f),
+                                false, sf::Vector2f(), true);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, system->getIslandCount());
+    ASSERT_EQ(2, debugWall->collisions.size());
+}
+
+//! Make two circles knock each other onto new tracks at the same time, and record the order of every callback.
+/*!
+* The Entities get the same IDs either way, but freeing the Entities which used their slots as a batch hands
+* the memory out in address order, while freeing them one at a time hands it out in reverse.
+*/
+static std::pair<std::vector<std::pair<ECSE::Entity::ID, ECSE::Entity::ID>>, bool> jumpTracks(bool batchFree)
+{
+    ECSE::World world(nullptr);
+    world.addSystem<ECSE::CollisionSystem>();
+    world.addSystem<ECSE::TransformSystem>();
+
+    auto fillers = world.createEntities(4);
+    for (auto id : fillers)
+    {
+        if (batchFree)
+        {
+            world.destroyEntity(id);
+        }
+        else
+        {
+            world.EntityManager::destroyEntity(id);
+        }
+    }
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    std::vector<std::pair<ECSE::Entity::ID, ECSE::Entity::ID>> order;
+    std::vector<ECSE::Entity*> entities;
+
+    // A hits B, then each is moved onto a track where it hits another circle at the same time
+    sf::Vector2f starts[] = {
+        sf::Vector2f(0.f, 0.f), sf::Vector2f(6.f, 0.f), sf::Vector2f(6.f, 200.f), sf::Vector2f(6.f, 300.f)
+    };
+    sf::Vector2f ends[] = {
+        sf::Vector2f(10.f, 0.f), sf::Vector2f(6.f, 0.f), sf::Vector2f(6.f, 200.f), sf::Vector2f(6.f, 300.f)
+    };
+    float tracks[] = { 200.f, 300.f, 0.f, 0.f };
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ECSE::Entity::ID id = createMovingEntity(world, starts[i], ends[i]);
+        auto collider = world.attachComponent<ECSE::CircleColliderComponent>(id);
+        collider->radius = 1.f;
+
+        float track = tracks[i];
+        collider->addCallback([&order, track](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+        {
+            order.push_back(std::make_pair(collision.self->getID(), collision.other->getID()));
+            if (track == 0.f || collision.position.y != 0.f) return {};
+
+            auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+            tc->setLocalPosition(sf::Vector2f(0.f, track), false);
+            tc->setNextLocalPosition(sf::Vector2f(10.f, track));
+
+            return { collision.self };
+        });
+
+        entities.push_back(world.registerEntity(id));
+    }
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    return std::make_pair(order, entities[0] < entities[1]);
+}
+
+TEST(CollisionSystemIslandTest, SimultaneousChangeOrderTest)
+{
+    auto batch = jumpTracks(true);
+    auto single = jumpTracks(false);
+
+    // Only worth checking if the Entities really were allocated in opposite orders
+    ASSERT_NE(batch.second, single.second);
+
+    ASSERT_EQ(6, batch.first.size());
+    ASSERT_EQ(batch.first, single.first);
+}
+
+//! Bounce a bunch of circles around a box in a single step, and record what each one hit.
+static std::vector<std::vector<std::tuple<ECSE::Entity::ID, float, float, float>>> bounceCircles(size_t workerCount)
+{
+    ECSE::World world(nullptr);
+    auto system = world.addSystem<ECSE::CollisionSystem>();
+    world.addSystem<ECSE::TransformSystem>();
+    system->setWorkerCount(workerCount);
+
+    // Walls
+    sf::Vector2f corners[] = {
+        sf::Vector2f(0.f, 0.f), sf::Vector2f(400.f, 0.f), sf::Vector2f(400.f, 400.f), sf::Vector2f(0.f, 400.f)
+    };
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ECSE::Entity::ID id = createMovingEntity(world, corners[i], corners[i]);
+        auto collider = world.attachComponent<ECSE::LineColliderComponent>(id);
+        collider->vec = corners[(i + 1) % 4] - corners[i];
+        collider->isStatic = true;
+        world.registerEntity(id);
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> speedDist(-150.f, 150.f);
+    std::vector<std::vector<std::tuple<ECSE::Entity::ID, float, float, float>>> hits(64);
+
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        sf::Vector2f start(30.f + 45.f * (i % 8), 30.f + 45.f * (i / 8));
+        ECSE::Entity::ID id = createMovingEntity(world, start, start + sf::Vector2f(speedDist(rng), speedDist(rng)));
+
+        // Reflect the rest of the movement about the normal
+        auto collider = world.attachComponent<ECSE::CircleColliderComponent>(id);
+        collider->radius = 5.f;
+        collider->addCallback([&hits, i](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+        {
+            hits[i].push_back(std::make_tuple(collision.other->getID(), collision.time,
+                                              collision.position.x, collision.position.y));
+
+            auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+            auto remaining = tc->getNextLocalPosition() - collision.position;
+            float dot = remaining.x * collision.normal.x + remaining.y * collision.normal.y;
+            if (dot <= 0.f) return { };
+
+            tc->setLocalPosition(collision.position, false);
+            tc->setNextLocalPosition(collision.position + remaining - 2.f * dot * collision.normal);
+
+            return { collision.self };
+        });
+
+        world.registerEntity(id);
+    }
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    EXPECT_LT(1, system->getIslandCount());
+
+    return hits;
+}
+
+TEST(CollisionSystemIslandTest, WorkerCountTest)
+{
+    auto serial = bounceCircles(0);
+
+    size_t hitCount = 0;
+    for (auto& hits : serial)
+    {
+        hitCount += hits.size();
+    }
+    ASSERT_LT(20, hitCount);
+
+    ASSERT_EQ(serial, bounceCircles(1));
+    ASSERT_EQ(serial, bounceCircles(4));
+}
+
+//! Bounce compound colliders around a box, adding or removing parts every time one hits something.
+static std::vector<std::vector<std::tuple<ECSE::Entity::ID, float, size_t, size_t>>> bounceCompounds(size_t workerCount)
+{
+    ECSE::World world(nullptr);
+    auto system = world.addSystem<ECSE::CollisionSystem>();
+    world.addSystem<ECSE::TransformSystem>();
+    system->setWorkerCount(workerCount);
+
+    // Resting against a wall keeps changing the parts, so keep the step short
+    system->setMaxRounds(64);
+
+    sf::Vector2f corners[] = {
+        sf::Vector2f(0.f, 0.f), sf::Vector2f(400.f, 0.f), sf::Vector2f(400.f, 400.f), sf::Vector2f(0.f, 400.f)
+    };
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ECSE::Entity::ID id = createMovingEntity(world, corners[i], corners[i]);
+        auto collider = world.attachComponent<ECSE::LineColliderComponent>(id);
+        collider->vec = corners[(i + 1) % 4] - corners[i];
+        collider->isStatic = true;
+        world.registerEntity(id);
+    }
+
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> speedDist(-150.f, 150.f);
+    std::vector<std::vector<std::tuple<ECSE::Entity::ID, float, size_t, size_t>>> hits(36);
+
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        sf::Vector2f start(40.f + 60.f * (i % 6), 40.f + 60.f * (i / 6));
+        ECSE::Entity::ID id = createMovingEntity(world, start, start + sf::Vector2f(speedDist(rng), speedDist(rng)));
+
+        auto compound = world.attachComponent<ECSE::CompoundColliderComponent>(id);
+        compound->addCircle(sf::Vector2f(), 5.f);
+        compound->addCallback([&hits, i, compound](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+        {
+            hits[i].push_back(std::make_tuple(collision.other->getID(), collision.time, collision.part,
+                                              compound->parts.size()));
+
+            // Replacing the parts adds or removes circles and lines, which can't happen while islands are solved in parallel
+            if (compound->parts.size() == 1)
+            {
+                compound->addLine(sf::Vector2f(-3.f, 0.f), sf::Vector2f(6.f, 0.f));
+                compound->addCircle(sf::Vector2f(0.f, 2.f), 2.f);
+            }
+            else
+            {
+                compound->parts.erase(compound->parts.begin() + 1, compound->parts.end());
+            }
+
+            // Reflect the rest of the movement about the normal
+            auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+            auto remaining = tc->getNextLocalPosition() - collision.position;
+            float dot = remaining.x * collision.normal.x + remaining.y * collision.normal.y;
+            if (dot > 0.f)
+            {
+                tc->setLocalPosition(collision.position, false);
+                tc->setNextLocalPosition(collision.position + remaining - 2.f * dot * collision.normal);
+            }
+
+            return { collision.self };
+        });
+
+        world.registerEntity(id);
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        world.update(sf::Time::Zero);
+        world.advance();
+    }
+
+    EXPECT_LT(1, system->getIslandCount());
+
+    return hits;
+}
+
+TEST(CollisionSystemIslandTest, WorkerCompoundPartsTest)
+{
+    auto serial = bounceCompounds(0);
+
+    size_t hitCount = 0;
+    for (auto& hits : serial)
+    {
+        hitCount += hits.size();
+    }
+    ASSERT_LT(20, hitCount);
+
+    ASSERT_EQ(serial, bounceCompounds(1));
+    ASSERT_EQ(serial, bounceCompounds(4));
+}
+
+//! Stop a parent when it hits something, while its child hits something far away, and record every hit.
+static std::pair<std::vector<std::tuple<ECSE::Entity::ID, ECSE::Entity::ID, float>>, size_t> stopParent(size_t workerCount)
+{
+    ECSE::World world(nullptr);
+    auto system = world.addSystem<ECSE::CollisionSystem>();
+    auto transformSystem = world.addSystem<ECSE::TransformSystem>();
+    system->setWorkerCount(workerCount);
+
+    std::vector<std::tuple<ECSE::Entity::ID, ECSE::Entity::ID, float>> hits;
+    auto record = [&hits](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        hits.push_back(std::make_tuple(collision.self->getID(), collision.other->getID(), collision.time));
+        return {};
+    };
+
+    sf::Vector2f starts[] = {
+        sf::Vector2f(0.f, 0.f), sf::Vector2f(6.f, 0.f), sf::Vector2f(0.f, 100.f), sf::Vector2f(7.f, 100.f)
+    };
+    sf::Vector2f ends[] = {
+        sf::Vector2f(10.f, 0.f), sf::Vector2f(6.f, 0.f), sf::Vector2f(0.f, 100.f), sf::Vector2f(7.f, 100.f)
+    };
+
+    std::vector<ECSE::Entity*> entities;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ECSE::Entity::ID id = createMovingEntity(world, starts[i], ends[i]);
+        auto collider = world.attachComponent<ECSE::CircleColliderComponent>(id);
+        collider->radius = 1.f;
+        collider->addCallback(record);
+
+        entities.push_back(world.registerEntity(id));
+    }
+
+    // The parent stops where it hits, which the child's island reads through the child's transform
+    entities[0]->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position);
+
+        return { collision.self };
+    });
+
+    transformSystem->parentEntity(*entities[2], *entities[0]);
+    auto childTransform = entities[2]->getComponent<ECSE::TransformComponent>();
+    childTransform->setLocalPosition(sf::Vector2f(0.f, 100.f), false);
+    childTransform->setNextLocalPosition(sf::Vector2f(0.f, 100.f));
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    return std::make_pair(hits, system->getIslandCount());
+}
+
+TEST(CollisionSystemIslandTest, WorkerParentTest)
+{
+    auto serial = stopParent(0);
+
+    // The child is far from its parent, but it has to be solved with it
+    ASSERT_EQ(1, serial.second);
+    ASSERT_LE(2, serial.first.size());
+
+    ASSERT_EQ(serial, stopParent(1));
+    ASSERT_EQ(serial, stopParent(4));
+}
+
+TEST_F(CollisionSystemTest, LayerMaskTest)
+{
+    ECSE::Entity *entA, *entB;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f, false, sf::Vector2f(), &entA);
+    auto debugB = createCircle(sf::Vector2f(12.f, 0.f), sf::Vector2f(12.f, 0.f), 3.f, false, sf::Vector2f(), &entB);
+
+    // B can collide with A's layer, but A can't collide with B's layer
+    auto colliderA = entA->getComponent<ECSE::CircleColliderComponent>();
+    auto colliderB = entB->getComponent<ECSE::CircleColliderComponent>();
+    colliderA->setLayer(1 << 0);
+    colliderA->setMask(1 << 0);
+    colliderB->setLayer(1 << 1);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(0, system->getPairCount());
+    ASSERT_EQ(0, debugA->collisions.size());
+    ASSERT_EQ(0, debugB->collisions.size());
+
+    // Now they agree
+    colliderA->setMask((1 << 0) | (1 << 1));
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, system->getPairCount());
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, StaticLayerMaskTest)
+{
+    ECSE::Entity* entA;
+    auto debugA = createCircle(sf::Vector2f(20.f, 0.f), sf::Vector2f(20.f, 40.f), 3.f, false, sf::Vector2f(), &entA);
+    createLine(sf::Vector2f(0.f, 20.f), sf::Vector2f(0.f, 20.f), sf::Vector2f(100.f, 0.f), false, sf::Vector2f(), true);
+
+    // Passes straight through the wall
+    entA->getComponent<ECSE::CircleColliderComponent>()->setMask(1 << 1);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(0, system->getPairCount());
+    ASSERT_EQ(0, debugA->collisions.size());
+}
+
+//! Redirect circle A upward when it hits circle B, changing A's mask at the same time.
+static void testMaskChangeRedirect(CollisionSystemTest& test, std::uint32_t initialMask, std::uint32_t newMask,
+                                   size_t expectedCollisions)
+{
+    ECSE::Entity *entA, *entC;
+    auto debugA = test.createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f, false, sf::Vector2f(), &entA);
+    test.createCircle(sf::Vector2f(50.f, 0.f), sf::Vector2f(50.f, 0.f), 5.f);
+    test.createCircle(sf::Vector2f(40.f, 40.f), sf::Vector2f(40.f, 40.f), 5.f, false, sf::Vector2f(), &entC);
+
+    auto colliderA = entA->getComponent<ECSE::CircleColliderComponent>();
+    colliderA->setMask(initialMask);
+    entC->getComponent<ECSE::CircleColliderComponent>()->setLayer(1 << 1);
+
+    bool hasHit = false;
+    colliderA->addCallback([&, colliderA](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        if (hasHit) return { };
+
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(collision.position + sf::Vector2f(0.f, 50.f));
+        colliderA->setMask(newMask);
+
+        hasHit = true;
+
+        return { collision.self };
+    });
+
+    test.world.update(sf::Time::Zero);
+    test.world.advance();
+
+    ASSERT_EQ(expectedCollisions, debugA->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, MaskChangeRemovesPairTest)
+{
+    testMaskChangeRedirect(*this, ~0u, 1 << 0, 1);
+}
+
+TEST_F(CollisionSystemTest, MaskChangeAddsPairTest)
+{
+    testMaskChangeRedirect(*this, 1 << 0, ~0u, 2);
+}
+
+TEST_F(CollisionSystemTest, ShapeChangeTest)
+{
+    ECSE::Entity* entityA;
+    ECSE::Entity* entityB;
+    auto debugA = createCircle(sf::Vector2f(350.f, 10.f), sf::Vector2f(370.f, 75.f), 5.f, false, sf::Vector2f(), &entityA);
+    auto debugB = createCircle(sf::Vector2f(325.f, 25.f), sf::Vector2f(375.f, 25.f), 5.f, false, sf::Vector2f(), &entityB);
+
+    world.update(sf::Time::Zero);
+
+    // The near miss becomes a hit if the circles grow after they were added
+    entityA->getComponent<ECSE::CircleColliderComponent>()->radius = 20.f;
+    entityB->getComponent<ECSE::CircleColliderComponent>()->radius = 20.f;
+
+    world.advance();
+
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, RemoveShapeTest)
+{
+    ECSE::Entity* removed;
+    createCircle(sf::Vector2f(500.f, 500.f), sf::Vector2f(500.f, 500.f), 3.f, false, sf::Vector2f(), &removed);
+    auto debugA = createCircle(sf::Vector2f(20.f, 0.f), sf::Vector2f(20.f, 40.f), 3.f);
+    auto debugB = createLine(sf::Vector2f(0.f, 20.f), sf::Vector2f(0.f, 20.f), sf::Vector2f(100.f, 0.f));
+
+    world.update(sf::Time::Zero);
+
+    // The last shapes get moved into the removed one's place
+    world.destroyEntity(removed->getID());
+    world.update(sf::Time::Zero);
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(2, system->getEntities().size());
+
+    world.advance();
+
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, RemoveBeforeStaticTest)
+{
+    ECSE::Entity* removed;
+    ECSE::Entity* entityA;
+    createCircle(sf::Vector2f(500.f, 500.f), sf::Vector2f(500.f, 500.f), 3.f, false, sf::Vector2f(), &removed);
+    auto debugA = createCircle(sf::Vector2f(20.f, 0.f), sf::Vector2f(20.f, 40.f), 3.f, false, sf::Vector2f(), &entityA);
+    auto debugB = createLine(sf::Vector2f(0.f, 20.f), sf::Vector2f(0.f, 20.f), sf::Vector2f(100.f, 0.f), false, sf::Vector2f(), true);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+
+    // The static line is moved into the removed circle's place, and must still be found
+    world.destroyEntity(removed->getID());
+    world.update(sf::Time::Zero);
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(2, system->getEntities().size());
+
+    auto transform = entityA->getComponent<ECSE::TransformComponent>();
+    transform->setLocalPosition(sf::Vector2f(20.f, 0.f), true);
+    transform->setNextLocalPosition(sf::Vector2f(20.f, 40.f), false);
+
+    world.advance();
+
+    ASSERT_EQ(2, debugA->collisions.size());
+    ASSERT_EQ(2, debugB->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, SleepTest)
+{
+    system->setSleepSteps(2);
+
+    ECSE::Entity* sleeper;
+    ECSE::Entity* mover;
+    auto debugSleeper = createCircle(sf::Vector2f(0.f, 10.f), sf::Vector2f(0.f, 10.f), 1.f, false, sf::Vector2f(), &sleeper);
+    auto debugMover = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 1.f, false, sf::Vector2f(), &mover);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+    ASSERT_FALSE(system->isAsleep(*sleeper));
+
+    world.advance();
+    ASSERT_TRUE(system->isAsleep(*sleeper));
+    ASSERT_TRUE(system->isAsleep(*mover));
+    ASSERT_EQ(2, system->getSleepingCount());
+
+    // Writing to the transform wakes it up, and it can still hit sleeping colliders
+    mover->getComponent<ECSE::TransformComponent>()->setNextLocalPosition(sf::Vector2f(0.f, 10.f));
+    world.advance();
+
+    ASSERT_FALSE(system->isAsleep(*mover));
+    ASSERT_EQ(1, system->getSleepingCount());
+    ASSERT_EQ(1, debugSleeper->collisions.size());
+    ASSERT_EQ(1, debugMover->collisions.size());
+}
+
+TEST_F(CollisionSystemTest, SleepingPairTest)
+{
+    system->setSleepSteps(2);
+
+    // Overlapping colliders keep colliding until they both fall asleep
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 2.f);
+    auto debugB = createCircle(sf::Vector2f(0.f, 1.f), sf::Vector2f(0.f, 1.f), 2.f);
+
+    world.update(sf::Time::Zero);
+    for (int i = 0; i < 4; ++i)
+    {
+        world.advance();
+    }
+
+    ASSERT_EQ(1, debugA->collisions.size());
+    ASSERT_EQ(1, debugB->collisions.size());
+    ASSERT_EQ(0, system->getPairCount());
+}
+
+TEST_F(CollisionSystemTest, QueryTest)
+{
+    ECSE::Entity* a;
+    ECSE::Entity* b;
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 2.f, false, sf::Vector2f(), &a);
+    createCircle(sf::Vector2f(20.f, 0.f), sf::Vector2f(20.f, 0.f), 2.f, false, sf::Vector2f(), &b);
+    createLine(sf::Vector2f(10.f, -5.f), sf::Vector2f(10.f, -5.f), sf::Vector2f(0.f, 10.f), false, sf::Vector2f(), true);
+    b->getComponent<ECSE::CircleColliderComponent>()->setLayer(2);
+
+    // Queries work as soon as Entities are added, before the first step
+    world.update(sf::Time::Zero);
+
+    ECSE::CollisionSystem::QueryHit hit;
+    ASSERT_TRUE(system->raycast(sf::Vector2f(-10.f, 0.f), sf::Vector2f(30.f, 0.f), hit));
+    ASSERT_EQ(a, hit.entity);
+    ASSERT_FLOAT_EQ(8.f, hit.distance);
+    ASSERT_FLOAT_EQ(-2.f, hit.position.x);
+    ASSERT_FLOAT_EQ(-1.f, hit.normal.x);
+
+    world.advance();
+
+    // Hits the static line first unless it's masked out
+    ASSERT_TRUE(system->raycast(sf::Vector2f(5.f, 0.f), sf::Vector2f(30.f, 0.f), hit));
+    ASSERT_NE(a, hit.entity);
+    ASSERT_NE(b, hit.entity);
+    ASSERT_FLOAT_EQ(5.f, hit.distance);
+
+    ASSERT_TRUE(system->raycast(sf::Vector2f(5.f, 0.f), sf::Vector2f(30.f, 0.f), hit, 2));
+    ASSERT_EQ(b, hit.entity);
+    ASSERT_FLOAT_EQ(13.f, hit.distance);
+
+    ASSERT_FALSE(system->raycast(sf::Vector2f(5.f, 10.f), sf::Vector2f(30.f, 10.f), hit));
+
+    std::vector<ECSE::Entity*> results;
+    system->overlapCircle(sf::Vector2f(15.f, 0.f), 4.f, results);
+    ASSERT_EQ(1, results.size());
+    ASSERT_EQ(b, results[0]);
+
+    system->overlapAABB(ECSE::AABB(sf::Vector2f(-1.f, -1.f), sf::Vector2f(11.f, 1.f)), results);
+    ASSERT_EQ(2, results.size());
+    ASSERT_NE(results.end(), std::find(results.begin(), results.end(), a));
+
+    system->overlapAABB(ECSE::AABB(sf::Vector2f(-1.f, -1.f), sf::Vector2f(11.f, 1.f)), results, 2);
+    ASSERT_TRUE(results.empty());
+
+    ASSERT_TRUE(system->nearest(sf::Vector2f(15.f, 1.f), hit));
+    ASSERT_EQ(b, hit.entity);
+
+    ASSERT_TRUE(system->nearest(sf::Vector2f(15.f, 1.f), hit, 1));
+    ASSERT_NE(b, hit.entity);
+    ASSERT_FLOAT_EQ(5.f, hit.distance);
+    ASSERT_FLOAT_EQ(10.f, hit.position.x);
+    ASSERT_FLOAT_EQ(1.f, hit.normal.x);
+
+    ASSERT_FALSE(system->nearest(sf::Vector2f(15.f, 1.f), hit, 1, 4.f));
+
+    ASSERT_TRUE(system->nearest(sf::Vector2f(0.5f, 0.f), hit));
+    ASSERT_EQ(a, hit.entity);
+    ASSERT_FLOAT_EQ(0.f, hit.distance);
+}
+
+TEST_F(CollisionSystemTest, QueryAfterMoveTest)
+{
+    ECSE::Entity* a;
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 2.f, false, sf::Vector2f(), &a);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    std::vector<ECSE::Entity*> results;
+    system->overlapCircle(sf::Vector2f(0.f, 0.f), 1.f, results);
+    ASSERT_EQ(1, results.size());
+
+    a->getComponent<ECSE::TransformComponent>()->setLocalPosition(sf::Vector2f(50.f, 0.f));
+    world.advance();
+
+    system->overlapCircle(sf::Vector2f(0.f, 0.f), 1.f, results);
+    ASSERT_TRUE(results.empty());
+
+    system->overlapCircle(sf::Vector2f(50.f, 0.f), 1.f, results);
+    ASSERT_EQ(1, results.size());
+}
+
+TEST_F(CollisionSystemTest, CompoundTest)
+{
+    using namespace std::placeholders;
+
+    ECSE::Entity* removed;
+    createCircle(sf::Vector2f(500.f, 500.f), sf::Vector2f(500.f, 500.f), 3.f, false, sf::Vector2f(), &removed);
+
+    ECSE::Entity *upper, *lower;
+    auto debugUpper = createCircle(sf::Vector2f(0.f, -20.f), sf::Vector2f(100.f, -20.f), 5.f, false, sf::Vector2f(), &upper);
+    auto debugLower = createCircle(sf::Vector2f(0.f, 20.f), sf::Vector2f(100.f, 20.f), 5.f, false, sf::Vector2f(), &lower);
+
+    // A circle above the Entity's position and a line below it, neither of which touch the position itself
+    ECSE::Entity::ID id = createMovingEntity(world, sf::Vector2f(50.f, 0.f), sf::Vector2f(50.f, 0.f));
+    auto debugCompound = world.attachComponent<CollisionDebugComponent>(id);
+    auto compound = world.attachComponent<ECSE::CompoundColliderComponent>(id);
+    ASSERT_EQ(0, compound->addCircle(sf::Vector2f(0.f, -20.f), 5.f));
+    ASSERT_EQ(1, compound->addLine(sf::Vector2f(0.f, 10.f), sf::Vector2f(0.f, 20.f)));
+    compound->addCallback(std::bind(&CollisionDebugComponent::onCollide, debugCompound, _1));
+    auto entity = world.registerEntity(id);
+
+    world.update(sf::Time::Zero);
+
+    // Removing a circle moves the compound's circle parameters into its place
+    world.destroyEntity(removed->getID());
+    world.update(sf::Time::Zero);
+    world.update(sf::Time::Zero);
+
+    ECSE::CollisionSystem::QueryHit hit;
+    ASSERT_TRUE(system->raycast(sf::Vector2f(50.f, -40.f), sf::Vector2f(50.f, 40.f), hit));
+    ASSERT_EQ(entity, hit.entity);
+    ASSERT_EQ(0, hit.part);
+    ASSERT_FLOAT_EQ(-25.f, hit.position.y);
+
+    ASSERT_TRUE(system->nearest(sf::Vector2f(60.f, 25.f), hit));
+    ASSERT_EQ(entity, hit.entity);
+    ASSERT_EQ(1, hit.part);
+
+    world.advance();
+
+    ASSERT_EQ(1, debugUpper->collisions.size());
+    ASSERT_EQ(entity, debugUpper->collisions[0].other);
+    ASSERT_EQ(ECSE::Collision::noPart, debugUpper->collisions[0].part);
+    ASSERT_EQ(0, debugUpper->collisions[0].otherPart);
+    ASSERT_FLOAT_EQ(0.4f, debugUpper->collisions[0].time);
+
+    ASSERT_EQ(1, debugLower->collisions.size());
+    ASSERT_EQ(1, debugLower->collisions[0].otherPart);
+    ASSERT_FLOAT_EQ(0.45f, debugLower->collisions[0].time);
+
+    ASSERT_EQ(2, debugCompound->collisions.size());
+    ASSERT_EQ(0, debugCompound->collisions[0].part);
+    ASSERT_EQ(1, debugCompound->collisions[1].part);
+
+    // Removing the circle changes the type of part 0
+    compound->parts.erase(compound->parts.begin());
+    for (auto mover : { upper, lower })
+    {
+        auto tc = mover->getComponent<ECSE::TransformComponent>();
+        tc->setLocalPosition(sf::Vector2f(0.f, tc->getLocalPosition().y), false);
+        tc->setNextLocalPosition(sf::Vector2f(100.f, tc->getLocalPosition().y));
+    }
+    world.advance();
+
+    ASSERT_EQ(1, debugUpper->collisions.size());
+    ASSERT_EQ(2, debugLower->collisions.size());
+    ASSERT_EQ(0, debugLower->collisions[1].otherPart);
+}
+
+TEST_F(CollisionSystemTest, ResponseTest)
+{
+    // A wall which every circle hits at x = 45, about halfway through the step
+    createLine(sf::Vector2f(50.f, -1000.f), sf::Vector2f(50.f, -1000.f), sf::Vector2f(0.f, 2000.f), false, sf::Vector2f(), true);
+
+    ECSE::Entity *reflect, *bounce, *slide, *stop;
+    auto debugReflect = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(100.f, 0.f), 5.f, false, sf::Vector2f(), &reflect);
+    createCircle(sf::Vector2f(0.f, 200.f), sf::Vector2f(100.f, 200.f), 5.f, false, sf::Vector2f(), &bounce);
+    createCircle(sf::Vector2f(0.f, 400.f), sf::Vector2f(100.f, 500.f), 5.f, false, sf::Vector2f(), &slide);
+    createCircle(sf::Vector2f(0.f, 600.f), sf::Vector2f(100.f, 600.f), 5.f, false, sf::Vector2f(), &stop);
+
+    reflect->getComponent<ECSE::CircleColliderComponent>()->response = ECSE::ColliderComponent::REFLECT;
+    bounce->getComponent<ECSE::CircleColliderComponent>()->response = ECSE::ColliderComponent::REFLECT;
+    bounce->getComponent<ECSE::CircleColliderComponent>()->restitution = 0.5f;
+    slide->getComponent<ECSE::CircleColliderComponent>()->response = ECSE::ColliderComponent::SLIDE;
+    stop->getComponent<ECSE::CircleColliderComponent>()->response = ECSE::ColliderComponent::STOP;
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    auto getNext = [](ECSE::Entity* entity)
+    {
+        return entity->getComponent<ECSE::TransformComponent>()->getNextLocalPosition();
+    };
+
+    // Callbacks are still called
+    ASSERT_EQ(1, debugReflect->collisions.size());
+    ASSERT_FLOAT_EQ(1.f, debugReflect->collisions[0].normal.x);
+
+    ASSERT_FLOAT_EQ(-10.f, getNext(reflect).x);
+    ASSERT_FLOAT_EQ(0.f, getNext(reflect).y);
+    ASSERT_FLOAT_EQ(45.f, reflect->getComponent<ECSE::TransformComponent>()->getLocalPosition().x);
+
+    ASSERT_FLOAT_EQ(17.5f, getNext(bounce).x);
+
+    ASSERT_FLOAT_EQ(45.f, getNext(slide).x);
+    ASSERT_FLOAT_EQ(500.f, getNext(slide).y);
+
+    ASSERT_FLOAT_EQ(45.f, getNext(stop).x);
+    ASSERT_FLOAT_EQ(600.f, getNext(stop).y);
+}
+
+TEST_F(CollisionSystemTest, LineCircleNormalTest)
+{
+    // A moving line is always the first Entity of its pair with a static circle
+    ECSE::Entity::ID id = createMovingEntity(world, sf::Vector2f(50.f, 0.f), sf::Vector2f(50.f, 0.f));
+    auto collider = world.attachComponent<ECSE::CircleColliderComponent>(id);
+    collider->radius = 5.f;
+    collider->isStatic = true;
+    world.registerEntity(id);
+
+    auto debugLine = createLine(sf::Vector2f(0.f, -10.f), sf::Vector2f(100.f, -10.f), sf::Vector2f(0.f, 20.f));
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    ASSERT_EQ(1, debugLine->collisions.size());
+    ASSERT_FLOAT_EQ(1.f, debugLine->collisions[0].normal.x);
+}
+
+TEST_F(CollisionSystemTest, StatisticsTest)
+{
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(10.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f);
+    createCircle(sf::Vector2f(500.f, 0.f), sf::Vector2f(500.f, 0.f), 3.f);
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    auto statistics = system->getStatistics();
+    ASSERT_EQ(3, statistics.colliders);
+    ASSERT_EQ(1, statistics.pairs);
+    ASSERT_EQ(1, statistics.narrowphaseTests);
+    ASSERT_EQ(1, statistics.hits);
+    ASSERT_EQ(1, statistics.islands);
+    ASSERT_EQ(1, statistics.rounds);
+    ASSERT_EQ(1, statistics.cacheRebuilds);
+    ASSERT_LE(statistics.solveTime, statistics.totalTime);
+
+    // Caches are reused once nothing is added or removed
+    world.advance();
+    ASSERT_EQ(0, system->getStatistics().cacheRebuilds);
+
+    std::ostringstream stream;
+    stream << system->getStatistics();
+    ASSERT_NE(std::string::npos, stream.str().find("3 colliders"));
+}
+
+TEST_F(CollisionSystemTest, SensorTest)
+{
+    ECSE::Entity* sensor;
+    ECSE::Entity* mover;
+    auto debugSensor = createCircle(sf::Vector2f(10.f, 0.f), sf::Vector2f(10.f, 0.f), 3.f, false, sf::Vector2f(), &sensor);
+    auto debugMover = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 1.f, false, sf::Vector2f(), &mover);
+    sensor->getComponent<ECSE::CircleColliderComponent>()->isSensor = true;
+
+    auto transform = mover->getComponent<ECSE::TransformComponent>();
+
+    world.update(sf::Time::Zero);
+    world.advance();
+    ASSERT_TRUE(system->getSensorEvents().empty());
+
+    // Moving into the sensor doesn't cause a collision
+    transform->setNextLocalPosition(sf::Vector2f(10.f, 0.f));
+    world.advance();
+
+    ASSERT_EQ(0, system->getPairCount());
+    ASSERT_TRUE(debugSensor->collisions.empty());
+    ASSERT_TRUE(debugMover->collisions.empty());
+    ASSERT_EQ(1, system->getSensorEvents().size());
+    ASSERT_EQ(ECSE::SensorEvent::ENTER, system->getSensorEvents()[0].type);
+    ASSERT_EQ(sensor, system->getSensorEvents()[0].sensor);
+    ASSERT_EQ(mover, system->getSensorEvents()[0].other);
+
+    transform->setLocalPosition(sf::Vector2f(10.f, 0.f));
+    world.advance();
+    ASSERT_EQ(1, system->getSensorEvents().size());
+    ASSERT_EQ(ECSE::SensorEvent::STAY, system->getSensorEvents()[0].type);
+
+    transform->setLocalPosition(sf::Vector2f(30.f, 0.f));
+    world.advance();
+    ASSERT_EQ(1, system->getSensorEvents().size());
+    ASSERT_EQ(ECSE::SensorEvent::EXIT, system->getSensorEvents()[0].type);
+
+    world.advance();
+    ASSERT_TRUE(system->getSensorEvents().empty());
+}
+
+TEST_F(CollisionSystemTest, StaticSensorTest)
+{
+    ECSE::Entity* sensor;
+    ECSE::Entity* mover;
+    createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f), 5.f, false, sf::Vector2f(), &sensor);
+    createCircle(sf::Vector2f(3.f, 0.f), sf::Vector2f(3.f, 0.f), 1.f, false, sf::Vector2f(), &mover);
+    createLine(sf::Vector2f(-2.f, -10.f), sf::Vector2f(-2.f, -10.f), sf::Vector2f(0.f, 20.f), false, sf::Vector2f(), true);
+
+    auto sensorCollider = sensor->getComponent<ECSE::CircleColliderComponent>();
+    sensorCollider->isSensor = true;
+    sensorCollider->isStatic = true;
+
+    // Static colliders aren't detected by static sensors
+    world.update(sf::Time::Zero);
+    world.advance();
+    ASSERT_EQ(1, system->getSensorEvents().size());
+    ASSERT_EQ(ECSE::SensorEvent::ENTER, system->getSensorEvents()[0].type);
+    ASSERT_EQ(mover, system->getSensorEvents()[0].other);
+
+    // Removing an Entity forgets its overlaps without an EXIT event
+    world.destroyEntity(mover->getID());
+    world.update(sf::Time::Zero);
+    world.advance();
+    ASSERT_TRUE(system->getSensorEvents().empty());
+}
+
+TEST_F(CollisionSystemTest, RoundBudgetTest)
+{
+    system->setMaxRounds(3);
+
+    ECSE::Entity* entA;
+    auto debugA = createCircle(sf::Vector2f(0.f, 0.f), sf::Vector2f(98.f, 0.f), 1.f, false, sf::Vector2f(), &entA);
+
+    createLine(sf::Vector2f(-5.f, -50.f), sf::Vector2f(-5.f, -50.f), sf::Vector2f(0.f, 100.f), false, sf::Vector2f(), true);
+    createLine(sf::Vector2f(5.f, -50.f), sf::Vector2f(5.f, -50.f), sf::Vector2f(0.f, 100.f), false, sf::Vector2f(), true);
+
+    entA->getComponent<ECSE::CircleColliderComponent>()->addCallback(
+        [&](const ECSE::Collision& collision) -> ECSE::ColliderComponent::ChangeSet
+    {
+        auto tc = collision.self->getComponent<ECSE::TransformComponent>();
+        auto next = tc->getNextLocalPosition();
+        next.x = 2.f * collision.position.x - next.x;
+
+        tc->setLocalPosition(collision.position, false);
+        tc->setNextLocalPosition(next);
+
+        return { collision.self };
+    });
+
+    world.update(sf::Time::Zero);
+    world.advance();
+
+    // The rest of the movement is dropped rather than passing through a wall
+    ASSERT_EQ(3, debugA->collisions.size());
+    ASSERT_EQ(1, system->getOverflowCount());
+    ASSERT_EQ(1, system->getTotalOverflowCount());
+
+    auto next = entA->getComponent<ECSE::TransformComponent>()->getNextLocalPosition();
+    ASSERT_FLOAT_EQ(debugA->collisions[2].position.x, next.x);
+
+    world.advance();
+    ASSERT_EQ(0, system->getOverflowCount());
+    ASSERT_EQ(1, system->getTotalOverflowCount());
+}
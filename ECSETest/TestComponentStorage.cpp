@@ -0,0 +1,244 @@
+#include "gtest/gtest.h"
+#include "ECSE/CircleColliderComponent.h"
+#include "ECSE/Logging.h"
+#include "ECSE/TransformComponent.h"
+#include "ECSE/World.h"
+
+class ComponentStorageTest : public ::testing::Test
+{
+public:
+    ComponentStorageTest()
+        : world(nullptr)
+    {
+    }
+
+    void SetUp() override
+    {
+        world.setStorageMode(ECSE::ComponentManager::ARCHETYPE_STORAGE);
+    }
+
+    ECSE::Entity* createEntity(sf::Vector2f position, float radius)
+    {
+        auto id = world.createEntity();
+        world.attachComponent<ECSE::TransformComponent>(id)->setLocalPosition(position);
+
+        if (radius > 0.f)
+        {
+            world.attachComponent<ECSE::CircleColliderComponent>(id)->radius = radius;
+        }
+
+        return world.registerEntity(id);
+    }
+
+    ECSE::World world;
+};
+
+//! Counts how many instances are alive, to check stored Components are destroyed exactly once.
+class CountedComponent : public ECSE::Component
+{
+public:
+    CountedComponent() { ++alive; }
+    CountedComponent(const CountedComponent& other) : ECSE::Component(other), value(other.value) { ++alive; }
+    ~CountedComponent() { --alive; }
+
+    int value = 0;
+    static int alive;
+};
+
+int CountedComponent::alive = 0;
+
+TEST_F(ComponentStorageTest, TestStoreKeepsData)
+{
+    ECSE::Entity* e = createEntity(sf::Vector2f(1.f, 2.f), 3.f);
+
+    auto* trans = e->getComponent<ECSE::TransformComponent>();
+    auto* circle = e->getComponent<ECSE::CircleColliderComponent>();
+
+    ASSERT_EQ(sf::Vector2f(1.f, 2.f), trans->getLocalPosition());
+    ASSERT_EQ(3.f, circle->radius);
+    ASSERT_EQ(circle, e->getComponent<ECSE::ColliderComponent>());
+    ASSERT_EQ(1, world.getArchetypeStorage().getArchetypeCount());
+}
+
+TEST_F(ComponentStorageTest, TestRefetchAfterRegister)
+{
+    auto id = world.createEntity();
+    auto* attached = world.attachComponent<ECSE::CircleColliderComponent>(id);
+    attached->radius = 4.f;
+
+    ECSE::Entity* e = world.registerEntity(id);
+
+    // Registering moved the Component, so the pointer from attachComponent has to be fetched again
+    auto* stored = e->getComponent<ECSE::CircleColliderComponent>();
+    ASSERT_NE(attached, stored);
+    ASSERT_EQ(4.f, stored->radius);
+    ASSERT_EQ(stored, world.getEntity(id)->getComponent<ECSE::ColliderComponent>());
+}
+
+TEST_F(ComponentStorageTest, TestForEach)
+{
+    ECSE::Entity* a = createEntity(sf::Vector2f(1.f, 0.f), 1.f);
+    createEntity(sf::Vector2f(2.f, 0.f), 0.f);
+    ECSE::Entity* c = createEntity(sf::Vector2f(3.f, 0.f), 2.f);
+
+    std::vector<ECSE::Entity*> visited;
+    world.getArchetypeStorage().forEach<ECSE::TransformComponent, ECSE::CircleColliderComponent>(
+        [&](ECSE::Entity& e, ECSE::TransformComponent& trans, ECSE::CircleColliderComponent& circle)
+    {
+        ASSERT_EQ(e.getComponent<ECSE::TransformComponent>(), &trans);
+        ASSERT_EQ(e.getComponent<ECSE::CircleColliderComponent>(), &circle);
+        visited.push_back(&e);
+    });
+
+    ASSERT_EQ((std::vector<ECSE::Entity*>{ a, c }), visited);
+
+    float total = 0.f;
+    world.getArchetypeStorage().forEach<ECSE::TransformComponent>(
+        [&](ECSE::Entity&, ECSE::TransformComponent& trans)
+    {
+        total += trans.getLocalPosition().x;
+    });
+
+    ASSERT_EQ(6.f, total);
+    ASSERT_EQ(2, world.getArchetypeStorage().getArchetypeCount());
+}
+
+TEST_F(ComponentStorageTest, TestReuseRow)
+{
+    ECSE::Entity* a = createEntity(sf::Vector2f(), 1.f);
+    createEntity(sf::Vector2f(), 1.f);
+    auto* oldTrans = a->getComponent<ECSE::TransformComponent>();
+
+    world.destroyEntity(a->getID());
+    world.update(sf::Time::Zero);
+
+    // The freed row is filled by the next Entity with the same Components
+    ECSE::Entity* c = createEntity(sf::Vector2f(5.f, 5.f), 1.f);
+    ASSERT_EQ(oldTrans, c->getComponent<ECSE::TransformComponent>());
+    ASSERT_EQ(sf::Vector2f(5.f, 5.f), c->getComponent<ECSE::TransformComponent>()->getLocalPosition());
+
+    int count = 0;
+    world.getArchetypeStorage().forEach<ECSE::TransformComponent>([&](ECSE::Entity&, ECSE::TransformComponent&)
+    {
+        ++count;
+    });
+    ASSERT_EQ(2, count);
+}
+
+TEST_F(ComponentStorageTest, TestCreateEntities)
+{
+    auto ids = world.createEntities<ECSE::TransformComponent, ECSE::CircleColliderComponent>(3,
+        [](ECSE::Entity&, ECSE::TransformComponent& trans, ECSE::CircleColliderComponent& circle)
+    {
+        trans.setLocalPosition(sf::Vector2f(1.f, 2.f));
+        circle.radius = 3.f;
+    });
+
+    // The Components set up before registering are moved into storage intact
+    int count = 0;
+    world.getArchetypeStorage().forEach<ECSE::TransformComponent, ECSE::CircleColliderComponent>(
+        [&](ECSE::Entity& e, ECSE::TransformComponent& trans, ECSE::CircleColliderComponent& circle)
+    {
+        ASSERT_EQ(ids[count++], e.getID());
+        ASSERT_EQ(sf::Vector2f(1.f, 2.f), trans.getLocalPosition());
+        ASSERT_EQ(3.f, circle.radius);
+    });
+
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(1, world.getArchetypeStorage().getArchetypeCount());
+}
+
+TEST_F(ComponentStorageTest, TestDestroyStored)
+{
+    {
+        ECSE::World otherWorld(nullptr);
+        otherWorld.setStorageMode(ECSE::ComponentManager::ARCHETYPE_STORAGE);
+
+        auto first = otherWorld.createEntity();
+        otherWorld.attachComponent<CountedComponent>(first)->value = 7;
+        otherWorld.registerEntity(first);
+
+        auto second = otherWorld.createEntity();
+        otherWorld.attachComponent<CountedComponent>(second);
+        otherWorld.registerEntity(second);
+
+        ASSERT_EQ(2, CountedComponent::alive);
+        ASSERT_EQ(7, otherWorld.getEntity(first)->getComponent<CountedComponent>()->value);
+
+        otherWorld.destroyEntity(first);
+        otherWorld.update(sf::Time::Zero);
+        ASSERT_EQ(1, CountedComponent::alive);
+    }
+
+    // Components still stored are destroyed along with the World
+    ASSERT_EQ(0, CountedComponent::alive);
+}
+
+//! Compares iterating Transform+Collider through pooled Components with iterating archetype storage.
+/*!
+* Run with --gtest_also_run_disabled_tests to see the timings.
+*/
+TEST(ComponentStorageBenchmark, DISABLED_BenchmarkIteration)
+{
+    const int entityCount = 100000;
+    const int iterations = 50;
+
+    auto fill = [&](ECSE::World& world)
+    {
+        for (int i = 0; i < entityCount; ++i)
+        {
+            auto id = world.createEntity();
+            world.attachComponent<ECSE::TransformComponent>(id)->setLocalPosition(sf::Vector2f(float(i), 0.f));
+
+            // Interleave other archetypes so pooled Components aren't perfectly ordered
+            if (i % 4 != 0)
+            {
+                world.attachComponent<ECSE::CircleColliderComponent>(id)->radius = 1.f;
+            }
+
+            world.registerEntity(id);
+        }
+    };
+
+    ECSE::World pooled(nullptr);
+    ECSE::World stored(nullptr);
+    stored.setStorageMode(ECSE::ComponentManager::ARCHETYPE_STORAGE);
+
+    sf::Clock clock;
+    fill(pooled);
+    sf::Time pooledFill = clock.restart();
+    fill(stored);
+    sf::Time storedFill = clock.restart();
+
+    float pooledSum = 0.f;
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (auto* e : pooled.getEntities())
+        {
+            auto* trans = e->getComponent<ECSE::TransformComponent>();
+            auto* circle = e->getComponent<ECSE::CircleColliderComponent>();
+            if (!trans || !circle) continue;
+
+            pooledSum += trans->getLocalPosition().x + circle->radius;
+        }
+    }
+    sf::Time pooledIterate = clock.restart();
+
+    float storedSum = 0.f;
+    for (int i = 0; i < iterations; ++i)
+    {
+        stored.getArchetypeStorage().forEach<ECSE::TransformComponent, ECSE::CircleColliderComponent>(
+            [&](ECSE::Entity&, ECSE::TransformComponent& trans, ECSE::CircleColliderComponent& circle)
+        {
+            storedSum += trans.getLocalPosition().x + circle.radius;
+        });
+    }
+    sf::Time storedIterate = clock.restart();
+
+    ASSERT_EQ(pooledSum, storedSum);
+
+    LOG(INFO) << "Create and register " << entityCount << " Entities: pools "
+              << pooledFill.asMilliseconds() << "ms, archetypes " << storedFill.asMilliseconds() << "ms";
+    LOG(INFO) << "Iterate Transform+Collider " << iterations << " times: pools "
+              << pooledIterate.asMilliseconds() << "ms, archetypes " << storedIterate.asMilliseconds() << "ms";
+}
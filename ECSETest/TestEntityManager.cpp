@@ -99,6 +99,52 @@ TEST_F(EntityManagerTest, ReplaceMemoryTest)
     ASSERT_EQ(entityA, entityB) << "Entities should backfill unused memory";
 }
 
+TEST_F(EntityManagerTest, StaleIDTest)
+{
+    ECSE::Entity::ID eID = manager.createEntity();
+    manager.destroyEntity(eID);
+    ECSE::Entity::ID newID = manager.createEntity();
+
+    ASSERT_EQ(ECSE::Entity::indexOf(eID), ECSE::Entity::indexOf(newID)) << "Freed slot should be reused";
+    ASSERT_EQ(nullptr, manager.getEntity(eID)) << "Stale ID shouldn't find the slot's new Entity";
+    ASSERT_THROW(manager.destroyEntity(eID), std::runtime_error) << "Stale ID shouldn't destroy the slot's new Entity";
+    ASSERT_NE(nullptr, manager.getEntity(newID));
+    ASSERT_EQ(nullptr, manager.getEntity(ECSE::Entity::invalidID));
+}
+
+TEST_F(EntityManagerTest, DestroyEntitiesTest)
+{
+    std::vector<ECSE::Entity::ID> ids;
+    std::vector<ECSE::Entity*> added;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        ids.push_back(manager.createEntity());
+        added.push_back(manager.getEntity(ids.back()));
+    }
+
+    std::vector<ECSE::Entity*> batch{ added[4], added[0], added[2] };
+    manager.destroyEntities(batch);
+
+    auto entities = manager.getEntities();
+    ASSERT_EQ(3, entities.size()) << "Three entities should have been removed";
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        bool destroyed = i % 2 == 0;
+        ASSERT_EQ(destroyed, manager.getEntity(ids[i]) == nullptr);
+        ASSERT_EQ(destroyed, !contains(entities, added[i]));
+    }
+
+    // Freed memory and slots are reused, lowest address first
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ECSE::Entity* e = manager.getEntity(manager.createEntity());
+        ASSERT_EQ(added[i * 2], e) << "Entities should backfill unused memory in address order";
+    }
+
+    ASSERT_EQ(6, manager.getEntities().size());
+}
+
 class SmallMaxIDEntityManager : public ECSE::EntityManager
 {
 public:
@@ -133,5 +179,6 @@ TEST_F(SmallMaxIDEntityManagerTest, ReuseIDTest)
 
     ECSE::Entity::ID newID = manager.createEntity();
 
-    ASSERT_EQ(eID, newID) << "ID should be reused";
+    ASSERT_EQ(ECSE::Entity::indexOf(eID), ECSE::Entity::indexOf(newID)) << "ID slot should be reused";
+    ASSERT_NE(eID, newID) << "Reused slot should have a new generation";
 }
@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include "ECSE/EntityManager.h"
+#include "ECSE/EntitySet.h"
+#include "TestUtils.h"
+#include <vector>
+
+class EntitySetTest : public ::testing::Test
+{
+public:
+    ECSE::Entity* createEntity()
+    {
+        return manager.getEntity(manager.createEntity());
+    }
+
+    ECSE::EntityManager manager;
+    ECSE::EntitySet set;
+};
+
+TEST_F(EntitySetTest, InsertTest)
+{
+    ECSE::Entity* e = createEntity();
+
+    ASSERT_TRUE(set.empty());
+    ASSERT_FALSE(set.contains(e));
+
+    ASSERT_TRUE(set.insert(e)) << "Entity should be added";
+    ASSERT_FALSE(set.insert(e)) << "Entity should only be added once";
+
+    ASSERT_EQ(1, set.size());
+    ASSERT_TRUE(set.contains(e));
+}
+
+TEST_F(EntitySetTest, EraseTest)
+{
+    ECSE::Entity* a = createEntity();
+    ECSE::Entity* b = createEntity();
+    ECSE::Entity* c = createEntity();
+    set.insert(a);
+    set.insert(b);
+    set.insert(c);
+
+    ASSERT_TRUE(set.erase(a));
+    ASSERT_FALSE(set.erase(a)) << "Entity should only be removed once";
+
+    // The last Entity fills the gap
+    ASSERT_EQ((std::vector<ECSE::Entity*>{ c, b }), std::vector<ECSE::Entity*>(set.begin(), set.end()));
+    ASSERT_FALSE(set.contains(a));
+    ASSERT_TRUE(set.contains(b));
+    ASSERT_TRUE(set.contains(c));
+}
+
+TEST_F(EntitySetTest, OrderTest)
+{
+    std::vector<ECSE::Entity*> entities;
+    for (int i = 0; i < 5; ++i)
+    {
+        entities.push_back(createEntity());
+    }
+
+    // Insertion order is kept regardless of the Entities' addresses or slot indices
+    for (auto it = entities.rbegin(); it != entities.rend(); ++it)
+    {
+        set.insert(*it);
+    }
+
+    ASSERT_EQ(std::vector<ECSE::Entity*>(entities.rbegin(), entities.rend()),
+              std::vector<ECSE::Entity*>(set.begin(), set.end()));
+
+    for (size_t i = 0; i < set.size(); ++i)
+    {
+        ASSERT_EQ(entities[entities.size() - 1 - i], set[i]);
+    }
+}
+
+TEST_F(EntitySetTest, ReusedSlotTest)
+{
+    ECSE::Entity* a = createEntity();
+    auto index = ECSE::Entity::indexOf(a->getID());
+    set.insert(a);
+    set.erase(a);
+    manager.destroyEntity(a);
+
+    // A new Entity in the same slot can be added
+    ECSE::Entity* b = createEntity();
+    ASSERT_EQ(index, ECSE::Entity::indexOf(b->getID()));
+    ASSERT_FALSE(set.contains(b));
+    ASSERT_TRUE(set.insert(b));
+    ASSERT_TRUE(set.contains(b));
+}
+
+TEST_F(EntitySetTest, ClearTest)
+{
+    ECSE::Entity* a = createEntity();
+    ECSE::Entity* b = createEntity();
+    set.insert(a);
+    set.insert(b);
+
+    set.clear();
+
+    ASSERT_TRUE(set.empty());
+    ASSERT_FALSE(set.contains(a));
+    ASSERT_FALSE(set.contains(b));
+    ASSERT_FALSE(contains(set, a));
+
+    ASSERT_TRUE(set.insert(b));
+    ASSERT_EQ(1, set.size());
+}
@@ -0,0 +1,180 @@
+#include "gtest/gtest.h"
+#include "ECSE/StaticBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+TEST(StaticBVHTest, EmptyTest)
+{
+    ECSE::StaticBVH bvh;
+    bvh.build({});
+
+    std::vector<size_t> results = { 1, 2, 3 };
+    bvh.query(ECSE::AABB(sf::Vector2f(-10.f, -10.f), sf::Vector2f(10.f, 10.f)), results);
+
+    ASSERT_EQ(0, bvh.size());
+    ASSERT_TRUE(results.empty());
+}
+
+TEST(StaticBVHTest, BoundsTest)
+{
+    ECSE::StaticBVH bvh;
+    bvh.build({
+        ECSE::AABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 10.f)),
+        ECSE::AABB(sf::Vector2f(-5.f, 20.f), sf::Vector2f(0.f, 30.f))
+    });
+
+    auto bounds = bvh.getBounds();
+
+    ASSERT_EQ(2, bvh.size());
+    ASSERT_FLOAT_EQ(-5.f, bounds.min.x);
+    ASSERT_FLOAT_EQ(0.f, bounds.min.y);
+    ASSERT_FLOAT_EQ(10.f, bounds.max.x);
+    ASSERT_FLOAT_EQ(30.f, bounds.max.y);
+}
+
+TEST(StaticBVHTest, MatchesBruteForceTest)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-500.f, 500.f);
+    std::uniform_real_distribution<float> sizeDist(1.f, 40.f);
+
+    std::vector<ECSE::AABB> bounds;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        sf::Vector2f min(posDist(rng), posDist(rng));
+        bounds.push_back(ECSE::AABB(min, min + sf::Vector2f(sizeDist(rng), sizeDist(rng))));
+    }
+
+    ECSE::StaticBVH bvh;
+    bvh.build(bounds);
+
+    std::vector<size_t> results;
+    for (size_t q = 0; q < 50; ++q)
+    {
+        sf::Vector2f min(posDist(rng), posDist(rng));
+        ECSE::AABB queryBounds(min, min + sf::Vector2f(sizeDist(rng), sizeDist(rng)) * 3.f);
+
+        bvh.query(queryBounds, results);
+        std::sort(results.begin(), results.end());
+
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < bounds.size(); ++i)
+        {
+            if (bounds[i].overlaps(queryBounds)) expected.push_back(i);
+        }
+
+        ASSERT_EQ(expected, results);
+    }
+}
+
+TEST(StaticBVHTest, ClearTest)
+{
+    ECSE::StaticBVH bvh;
+    bvh.build({ ECSE::AABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 10.f)) });
+    bvh.clear();
+
+    std::vector<size_t> results;
+    bvh.query(ECSE::AABB(sf::Vector2f(0.f, 0.f), sf::Vector2f(10.f, 10.f)), results);
+
+    ASSERT_EQ(0, bvh.size());
+    ASSERT_TRUE(results.empty());
+}
+
+TEST(StaticBVHTest, RaycastMatchesBruteForceTest)
+{
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> posDist(-500.f, 500.f);
+    std::uniform_real_distribution<float> sizeDist(1.f, 40.f);
+
+    std::vector<ECSE::AABB> bounds;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        sf::Vector2f min(posDist(rng), posDist(rng));
+        bounds.push_back(ECSE::AABB(min, min + sf::Vector2f(sizeDist(rng), sizeDist(rng))));
+    }
+
+    ECSE::StaticBVH bvh;
+    bvh.build(bounds);
+
+    // Treat each item as its bounds, and ignore every third one
+    auto hitTest = [&bounds](sf::Vector2f start, sf::Vector2f end, size_t index)
+    {
+        return index % 3 == 0 ? -1.f : ECSE::raycastAABB(start, end, bounds[index]);
+    };
+
+    for (size_t q = 0; q < 50; ++q)
+    {
+        sf::Vector2f start(posDist(rng), posDist(rng));
+        sf::Vector2f end(posDist(rng), posDist(rng));
+
+        float time = -1.f;
+        size_t result = bvh.raycast(start, end, [&](size_t index) { return hitTest(start, end, index); }, time);
+
+        size_t expected = ECSE::StaticBVH::notFound;
+        float expectedTime = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < bounds.size(); ++i)
+        {
+            float hit = hitTest(start, end, i);
+            if (hit >= 0.f && hit < expectedTime)
+            {
+                expected = i;
+                expectedTime = hit;
+            }
+        }
+
+        ASSERT_EQ(expected, result);
+        if (expected != ECSE::StaticBVH::notFound)
+        {
+            ASSERT_FLOAT_EQ(expectedTime, time);
+        }
+    }
+}
+
+TEST(StaticBVHTest, NearestMatchesBruteForceTest)
+{
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> posDist(-500.f, 500.f);
+
+    std::vector<sf::Vector2f> points;
+    std::vector<ECSE::AABB> bounds;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        points.push_back(sf::Vector2f(posDist(rng), posDist(rng)));
+        bounds.push_back(ECSE::AABB(points.back(), points.back()));
+    }
+
+    ECSE::StaticBVH bvh;
+    bvh.build(bounds);
+
+    for (size_t q = 0; q < 50; ++q)
+    {
+        sf::Vector2f point(posDist(rng), posDist(rng));
+        auto distanceTest = [&](size_t index)
+        {
+            sf::Vector2f diff = points[index] - point;
+            return std::sqrt(diff.x * diff.x + diff.y * diff.y);
+        };
+
+        float distance = -1.f;
+        size_t result = bvh.nearest(point, 100.f, distanceTest, distance);
+
+        size_t expected = ECSE::StaticBVH::notFound;
+        float expectedDistance = 100.f;
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            if (distanceTest(i) < expectedDistance)
+            {
+                expected = i;
+                expectedDistance = distanceTest(i);
+            }
+        }
+
+        ASSERT_EQ(expected, result);
+        if (expected != ECSE::StaticBVH::notFound)
+        {
+            ASSERT_FLOAT_EQ(expectedDistance, distance);
+        }
+    }
+}
@@ -1,16 +1,24 @@
 #include "gtest/gtest.h"
+#include "ECSE/EntityManager.h"
 #include "ECSE/SetSystem.h"
 #include "TestFixtures.h"
 
 class SystemTest : public ::testing::Test
 {
 public:
+    //! Create an Entity with a valid ID, which Systems use to key their sets.
+    ECSE::Entity& createEntity()
+    {
+        return *manager.getEntity(manager.createEntity());
+    }
+
+    ECSE::EntityManager manager;
     DummySystem system;
 };
 
 TEST_F(SystemTest, TestInspect)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.inspectEntity(e);
     system.addAndRemove();
@@ -23,7 +31,7 @@ TEST_F(SystemTest, TestInspect)
 
 TEST_F(SystemTest, TestInspectFailRequirements)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.passChecks = false;
     system.inspectEntity(e);
@@ -37,7 +45,7 @@ TEST_F(SystemTest, TestInspectFailRequirements)
 
 TEST_F(SystemTest, TestInspectTwice)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.inspectEntity(e);
     system.inspectEntity(e);
@@ -51,7 +59,7 @@ TEST_F(SystemTest, TestInspectTwice)
 
 TEST_F(SystemTest, TestAddTwice)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.inspectEntity(e);
     system.addAndRemove();
@@ -67,26 +75,27 @@ TEST_F(SystemTest, TestAddTwice)
 
 TEST_F(SystemTest, TestAddMultiple)
 {
-    ECSE::Entity added[5];
+    ECSE::Entity* added[5];
 
     for (auto& e : added)
     {
-        system.inspectEntity(e);
+        e = &createEntity();
+        system.inspectEntity(*e);
     }
     system.addAndRemove();
 
     auto entities = system.getEntities();
     ASSERT_EQ(5, entities.size()) << "Entities should be added";
 
-    for (ECSE::Entity &e : added)
+    for (ECSE::Entity* e : added)
     {
-        ASSERT_TRUE(system.hasEntity(e)) << "Entity should have been added";
+        ASSERT_TRUE(system.hasEntity(*e)) << "Entity should have been added";
     }
 }
 
 TEST_F(SystemTest, TestHasEntity)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.inspectEntity(e);
     system.addAndRemove();
@@ -96,14 +105,14 @@ TEST_F(SystemTest, TestHasEntity)
 
 TEST_F(SystemTest, TestHasEntityFalse)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     ASSERT_FALSE(system.hasEntity(e)) << "Entity was not added but hasEntity returned true";
 }
 
 TEST_F(SystemTest, TestRemove)
 {
-    ECSE::Entity e;
+    ECSE::Entity& e = createEntity();
 
     system.inspectEntity(e);
     system.addAndRemove();
@@ -118,8 +127,8 @@ TEST_F(SystemTest, TestRemove)
 
 TEST_F(SystemTest, TestMarkToRemoveTwice)
 {
-    ECSE::Entity e1;
-    ECSE::Entity e2;
+    ECSE::Entity& e1 = createEntity();
+    ECSE::Entity& e2 = createEntity();
 
     system.inspectEntity(e1);
     system.inspectEntity(e2);
@@ -137,8 +146,8 @@ TEST_F(SystemTest, TestMarkToRemoveTwice)
 
 TEST_F(SystemTest, TestRemoveTwice)
 {
-    ECSE::Entity e1;
-    ECSE::Entity e2;
+    ECSE::Entity& e1 = createEntity();
+    ECSE::Entity& e2 = createEntity();
 
     system.inspectEntity(e1);
     system.inspectEntity(e2);
@@ -158,22 +167,23 @@ TEST_F(SystemTest, TestRemoveTwice)
 
 TEST_F(SystemTest, TestRemoveMultiple)
 {
-    ECSE::Entity added[5];
+    ECSE::Entity* added[5];
 
     for (auto& e : added)
     {
-        system.inspectEntity(e);
+        e = &createEntity();
+        system.inspectEntity(*e);
     }
     system.addAndRemove();
 
-    system.markToRemove(added[1]);
-    system.markToRemove(added[4]);
+    system.markToRemove(*added[1]);
+    system.markToRemove(*added[4]);
     system.addAndRemove();
 
     auto entities = system.getEntities();
-    ASSERT_TRUE(system.hasEntity(added[0])) << "Entity should not have been removed";
-    ASSERT_FALSE(system.hasEntity(added[1])) << "Entity should have been removed";
-    ASSERT_TRUE(system.hasEntity(added[2])) << "Entity should not have been removed";
-    ASSERT_TRUE(system.hasEntity(added[3])) << "Entity should not have been removed";
-    ASSERT_FALSE(system.hasEntity(added[4])) << "Entity should have been removed";
+    ASSERT_TRUE(system.hasEntity(*added[0])) << "Entity should not have been removed";
+    ASSERT_FALSE(system.hasEntity(*added[1])) << "Entity should have been removed";
+    ASSERT_TRUE(system.hasEntity(*added[2])) << "Entity should not have been removed";
+    ASSERT_TRUE(system.hasEntity(*added[3])) << "Entity should not have been removed";
+    ASSERT_FALSE(system.hasEntity(*added[4])) << "Entity should have been removed";
 }
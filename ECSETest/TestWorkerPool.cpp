@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "ECSE/WorkerPool.h"
+#include <stdexcept>
+
+static void testRunsEveryJob(size_t workerCount)
+{
+    ECSE::WorkerPool pool(workerCount);
+    ASSERT_EQ(workerCount, pool.getWorkerCount());
+
+    // Run a few batches to make sure workers pick up each one
+    for (size_t batch = 0; batch < 20; ++batch)
+    {
+        std::vector<int> counts(100, 0);
+        pool.run(counts.size(), [&counts](size_t i) { ++counts[i]; });
+
+        for (int count : counts)
+        {
+            ASSERT_EQ(1, count);
+        }
+    }
+}
+
+TEST(WorkerPoolTest, NoWorkersTest)
+{
+    testRunsEveryJob(0);
+}
+
+TEST(WorkerPoolTest, WorkersTest)
+{
+    testRunsEveryJob(4);
+}
+
+TEST(WorkerPoolTest, EmptyBatchTest)
+{
+    ECSE::WorkerPool pool(2);
+    bool called = false;
+
+    pool.run(0, [&called](size_t) { called = true; });
+
+    ASSERT_FALSE(called);
+}
+
+TEST(WorkerPoolTest, ExceptionTest)
+{
+    ECSE::WorkerPool pool(2);
+    std::vector<int> counts(10, 0);
+
+    ASSERT_THROW(pool.run(counts.size(), [&counts](size_t i)
+    {
+        ++counts[i];
+        if (i == 3) throw std::runtime_error("Job failed");
+    }), std::runtime_error);
+
+    // The other jobs still ran
+    for (int count : counts)
+    {
+        ASSERT_EQ(1, count);
+    }
+}
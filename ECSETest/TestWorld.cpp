@@ -1,5 +1,8 @@
 #include "gtest/gtest.h"
 #include "ECSE/World.h"
+#include "ECSE/TransformComponent.h"
+#include "ECSE/TransformSystem.h"
+#include "ECSE/RenderSystem.h"
 #include "TestFixtures.h"
 #include "TestUtils.h"
 
@@ -324,6 +327,32 @@ TEST_F(WorldTest, TestAttacHierarchicalPolymorphicComponent)
     ASSERT_EQ(15, e->getComponent<TestComponentBase>()->getValue());
 }
 
+TEST_F(WorldTest, TestComponentMask)
+{
+    ECSE::Entity::ID id = world.createEntity();
+    world.attachComponent<TestComponentSeparateChild>(id);
+    world.attachComponent<TestComponentChild>(id);
+    ECSE::Entity* e = world.registerEntity(id);
+
+    // Each type gets its own dense ID, and the polymorphic bases are included in the mask
+    size_t childID = ECSE::ComponentTypeRegistry::getID<TestComponentChild>();
+    ASSERT_EQ(childID, ECSE::ComponentTypeRegistry::getID<TestComponentChild>());
+    ASSERT_LT(childID, ECSE::ComponentTypeRegistry::getTypeCount());
+
+    ECSE::ComponentMask expected = ECSE::ComponentTypeRegistry::getMask<TestComponentBase>()
+        | ECSE::ComponentTypeRegistry::getMask<TestComponentChild>()
+        | ECSE::ComponentTypeRegistry::getMask<TestComponentSeparateBase>()
+        | ECSE::ComponentTypeRegistry::getMask<TestComponentSeparateChild>();
+    ASSERT_EQ(expected, e->getComponentMask());
+    ASSERT_EQ(4, e->getComponents().size());
+
+    // Looking up a type that isn't attached doesn't find a neighbour
+    ASSERT_EQ(nullptr, e->getComponent<TestComponentChildChild>());
+    ASSERT_EQ(nullptr, e->getComponent<DummyComponent>());
+    ASSERT_EQ(2, e->getComponent<TestComponentSeparateBase>()->getValue());
+    ASSERT_EQ(10, e->getComponent<TestComponentBase>()->getValue());
+}
+
 TEST_F(WorldTest, TestAttachPolymorphicComponentByReference)
 {
     ECSE::Entity::ID id = world.createEntity();
@@ -382,6 +411,77 @@ TEST_F(WorldTest, TestDestroyEntity)
     ASSERT_EQ(nullptr, world.getEntity(id));
 }
 
+TEST_F(WorldTest, TestGetEntitiesSkipsDestroyed)
+{
+    ECSE::Entity::ID a = world.createEntity();
+    ECSE::Entity::ID b = world.createEntity();
+    ECSE::Entity::ID c = world.createEntity();
+
+    world.destroyEntity(b);
+
+    // The Entity is still in the EntityManager until the update, but shouldn't be enumerated
+    auto entities = world.getEntities();
+    ASSERT_EQ(3, world.EntityManager::getEntities().size());
+    ASSERT_EQ(2, entities.size());
+    ASSERT_EQ((std::vector<ECSE::Entity*>{ world.getEntity(a), world.getEntity(c) }),
+              std::vector<ECSE::Entity*>(entities.begin(), entities.end()));
+
+    world.destroyEntity(a);
+    world.destroyEntity(c);
+    ASSERT_TRUE(world.getEntities().empty());
+    ASSERT_EQ(world.getEntities().end(), world.getEntities().begin());
+
+    world.update(sf::Time::Zero);
+    ASSERT_TRUE(world.EntityManager::getEntities().empty());
+}
+
+TEST_F(WorldTest, TestDestroyManyEntities)
+{
+    DummyWorldSystem* sys = world.addSystem<DummyWorldSystem>();
+
+    std::vector<ECSE::Entity::ID> ids;
+    for (int i = 0; i < 100; ++i)
+    {
+        ECSE::Entity::ID id = world.createEntity();
+        world.attachComponent<DummyComponent>(id);
+        world.attachComponent<ECSE::TransformComponent>(id)->setLocalPosition(sf::Vector2f(float(i), 0.f));
+        world.registerEntity(id);
+        ids.push_back(id);
+    }
+
+    world.update(sf::Time::Zero);
+
+    // Destroy every other Entity in a single update
+    for (size_t i = 0; i < ids.size(); i += 2)
+    {
+        world.destroyEntity(ids[i]);
+        ASSERT_EQ(nullptr, world.getEntity(ids[i])) << "Entity should be unavailable as soon as it's marked";
+    }
+
+    world.update(sf::Time::Zero);
+
+    ASSERT_EQ(50, world.getEntities().size());
+    ASSERT_EQ(50, sys->getEntities().size());
+
+    for (size_t i = 1; i < ids.size(); i += 2)
+    {
+        ECSE::Entity* e = world.getEntity(ids[i]);
+        ASSERT_NE(nullptr, e);
+        ASSERT_EQ(float(i), e->getComponent<ECSE::TransformComponent>()->getLocalPosition().x);
+    }
+
+    // The freed memory can be used again
+    for (int i = 0; i < 50; ++i)
+    {
+        ECSE::Entity::ID id = world.createEntity();
+        world.attachComponent<ECSE::TransformComponent>(id);
+        world.registerEntity(id);
+    }
+
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(100, world.getEntities().size());
+}
+
 TEST_F(WorldTest, TestDestroyEntityDoesNotExist)
 {
     DummyWorldSystem* sys = world.addSystem<DummyWorldSystem>();
@@ -400,3 +500,307 @@ TEST_F(WorldTest, TestDestroyEntityDoesNotExist)
     world.update(sf::Time::Zero);
     world.advance();
 }
+
+TEST_F(WorldTest, TestView)
+{
+    ECSE::Entity::ID a = world.createEntity();
+    world.attachComponent<TestComponentChild>(a);
+    world.attachComponent<DummyComponent>(a);
+    world.registerEntity(a);
+
+    ECSE::Entity::ID b = world.createEntity();
+    world.attachComponent<TestComponentBase>(b);
+    world.registerEntity(b);
+
+    // Base types match polymorphic Components, and the tuple follows the order the types were given
+    std::vector<int> values;
+    for (auto components : world.view<DummyComponent, TestComponentBase>())
+    {
+        values.push_back(std::get<1>(components).getValue());
+    }
+    ASSERT_EQ(std::vector<int>{ 10 }, values);
+
+    auto view = world.view<TestComponentBase>();
+    ASSERT_EQ(2, view.size());
+
+    // Disabled Components are skipped
+    world.getEntity(a)->getComponent<TestComponentBase>()->enabled = false;
+    values.clear();
+    for (auto it = view.begin(); it != view.end(); ++it)
+    {
+        values.push_back(std::get<0>(*it).getValue());
+        ASSERT_EQ(b, it.getEntity().getID());
+    }
+    ASSERT_EQ(std::vector<int>{ 5 }, values);
+}
+
+//! A TransformSystem which only takes Entities on the right, so its membership is narrower than its signature.
+class NarrowTransformSystem : public ECSE::TransformSystem
+{
+public:
+    explicit NarrowTransformSystem(ECSE::World* world)
+        : TransformSystem(world)
+    {
+    }
+
+protected:
+    bool checkRequirements(const ECSE::Entity& e) const override
+    {
+        return e.getComponent<ECSE::TransformComponent>()->getLocalPosition().x >= 0.f;
+    }
+};
+
+TEST_F(WorldTest, TestSystemMembershipDiffersFromView)
+{
+    NarrowTransformSystem* sys = world.addSystem<NarrowTransformSystem>();
+
+    ECSE::Entity::ID member = world.createEntity();
+    auto* memberTrans = world.attachComponent<ECSE::TransformComponent>(member);
+    memberTrans->setLocalPosition(sf::Vector2f(1.f, 0.f));
+    memberTrans->setDeltaPosition(sf::Vector2f(1.f, 0.f));
+    world.registerEntity(member);
+
+    ECSE::Entity::ID outsider = world.createEntity();
+    auto* outsiderTrans = world.attachComponent<ECSE::TransformComponent>(outsider);
+    outsiderTrans->setLocalPosition(sf::Vector2f(-1.f, 0.f));
+    outsiderTrans->setDeltaPosition(sf::Vector2f(1.f, 0.f));
+    world.registerEntity(outsider);
+
+    auto view = world.view<ECSE::TransformComponent>();
+    world.update(sf::Time::Zero);
+
+    std::vector<ECSE::Entity*> viewed;
+    for (auto it = view.begin(); it != view.end(); ++it)
+    {
+        viewed.push_back(&it.getEntity());
+    }
+
+    // The view has every Entity with the Component, but the System only has the ones it accepted
+    ASSERT_EQ(2, viewed.size());
+    ASSERT_TRUE(contains(viewed, world.getEntity(outsider)));
+    ASSERT_EQ(1, sys->getEntities().size());
+    ASSERT_TRUE(sys->hasEntity(*world.getEntity(member)));
+
+    // The System's own view only has its members
+    auto sysView = sys->view<ECSE::TransformComponent>();
+    ASSERT_EQ(1, sysView.size());
+    ASSERT_EQ(world.getEntity(member), &sysView.begin().getEntity());
+
+    // So the System only advances its own members
+    world.advance();
+    ASSERT_EQ(sf::Vector2f(2.f, 0.f), memberTrans->getLocalPosition());
+    ASSERT_EQ(sf::Vector2f(-1.f, 0.f), outsiderTrans->getLocalPosition());
+}
+
+TEST_F(WorldTest, TestViewUpdates)
+{
+    ASSERT_EQ(0, world.view<DummyComponent>().size());
+
+    // New Entities join the view in update, like they join Systems
+    ECSE::Entity::ID a = world.createEntity();
+    world.attachComponent<DummyComponent>(a);
+    world.registerEntity(a);
+
+    ECSE::Entity::ID b = world.createEntity();
+    world.attachComponent<DummyComponent>(b);
+    world.registerEntity(b);
+
+    ASSERT_EQ(0, world.view<DummyComponent>().size());
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(2, world.view<DummyComponent>().size());
+
+    world.destroyEntity(a);
+    world.update(sf::Time::Zero);
+
+    auto view = world.view<DummyComponent>();
+    ASSERT_EQ(1, view.size());
+    ASSERT_EQ(b, view.begin().getEntity().getID());
+}
+
+TEST_F(WorldTest, TestSystemViewFollowsMembership)
+{
+    ECSE::TransformSystem* sys = world.addSystem<ECSE::TransformSystem>();
+
+    std::vector<ECSE::Entity::ID> ids;
+    for (int i = 0; i < 4; ++i)
+    {
+        ids.push_back(world.createEntity());
+        world.attachComponent<ECSE::TransformComponent>(ids.back());
+        world.registerEntity(ids.back());
+    }
+
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(4, sys->view<ECSE::TransformComponent>().size());
+
+    // Removing Entities keeps the view in the same order as the System's set
+    world.destroyEntity(ids[0]);
+    world.update(sf::Time::Zero);
+    world.getEntity(ids[2])->getComponent<ECSE::TransformComponent>()->enabled = false;
+
+    std::vector<ECSE::Entity*> viewed;
+    auto all = sys->view<ECSE::TransformComponent>().includingDisabled();
+    for (auto it = all.begin(); it != all.end(); ++it)
+    {
+        viewed.push_back(&it.getEntity());
+    }
+    ASSERT_EQ(std::vector<ECSE::Entity*>(sys->getEntities().begin(), sys->getEntities().end()), viewed);
+
+    // Disabled Components are skipped by default
+    viewed.clear();
+    auto enabled = sys->view<ECSE::TransformComponent>();
+    for (auto it = enabled.begin(); it != enabled.end(); ++it)
+    {
+        viewed.push_back(&it.getEntity());
+    }
+    ASSERT_EQ(2, viewed.size());
+    ASSERT_FALSE(contains(viewed, world.getEntity(ids[2])));
+}
+
+TEST_F(WorldTest, TestRenderSystemView)
+{
+    ECSE::RenderSystem* sys = world.addSystem<ECSE::RenderSystem>();
+    world.addSystem<ECSE::TransformSystem>();
+
+    std::vector<ECSE::Entity::ID> ids;
+    for (int i = 0; i < 3; ++i)
+    {
+        ids.push_back(world.createEntity());
+        world.attachComponent<ECSE::TransformComponent>(ids.back());
+        world.attachComponent<ECSE::SpriteComponent>(ids.back());
+        world.attachComponent<ECSE::DepthComponent>(ids.back())->depth = i;
+    }
+
+    // Without a DepthComponent, this one isn't rendered
+    ECSE::Entity::ID outsider = world.createEntity();
+    world.attachComponent<ECSE::TransformComponent>(outsider);
+    world.attachComponent<ECSE::SpriteComponent>(outsider);
+
+    for (auto id : ids)
+    {
+        world.registerEntity(id);
+    }
+    world.registerEntity(outsider);
+
+    world.update(sf::Time::Zero);
+    ASSERT_EQ(4, world.view<ECSE::SpriteComponent>().size());
+    ASSERT_EQ(3, sys->view<ECSE::SpriteComponent>().size());
+
+    // The view follows the System as Entities leave it
+    world.destroyEntity(ids[0]);
+    world.update(sf::Time::Zero);
+    world.getEntity(ids[2])->getComponent<ECSE::SpriteComponent>()->enabled = false;
+
+    std::vector<ECSE::Entity*> viewed;
+    auto view = sys->view<ECSE::SpriteComponent>();
+    for (auto it = view.begin(); it != view.end(); ++it)
+    {
+        viewed.push_back(&it.getEntity());
+    }
+    ASSERT_EQ(std::vector<ECSE::Entity*>{ world.getEntity(ids[1]) }, viewed);
+}
+
+class SignatureSystem : public DummyWorldSystem
+{
+public:
+    explicit SignatureSystem(ECSE::World* world)
+        : DummyWorldSystem(world)
+    {
+        require<TestComponentBase>();
+        exclude<TestComponentSeparateBase>();
+    }
+
+    mutable int checks = 0;
+
+protected:
+    bool checkRequirements(const ECSE::Entity& e) const override
+    {
+        ++checks;
+        return DummyWorldSystem::checkRequirements(e);
+    }
+};
+
+TEST_F(WorldTest, TestSystemSignature)
+{
+    SignatureSystem* sys = world.addSystem<SignatureSystem>();
+
+    ECSE::Entity::ID match = world.createEntity();
+    world.attachComponent<TestComponentChild>(match);
+    world.registerEntity(match);
+
+    ECSE::Entity::ID missing = world.createEntity();
+    world.attachComponent<DummyComponent>(missing);
+    world.registerEntity(missing);
+
+    ECSE::Entity::ID excluded = world.createEntity();
+    world.attachComponent<TestComponentBase>(excluded);
+    world.attachComponent<TestComponentSeparateChild>(excluded);
+    world.registerEntity(excluded);
+
+    world.update(sf::Time::Zero);
+
+    // Only the matching Entity should reach checkRequirements
+    ASSERT_EQ(1, sys->checks);
+    ASSERT_EQ(1, sys->getEntities().size());
+    ASSERT_TRUE(sys->hasEntity(*world.getEntity(match)));
+}
+
+TEST_F(WorldTest, TestCreateEntities)
+{
+    SignatureSystem* sys = world.addSystem<SignatureSystem>();
+    world.update(sf::Time::Zero);
+
+    int initialized = 0;
+    auto ids = world.createEntities<TestComponentChild, ECSE::TransformComponent>(10,
+        [&](ECSE::Entity&, TestComponentChild&, ECSE::TransformComponent& trans)
+    {
+        trans.setLocalPosition(sf::Vector2f(float(initialized++), 0.f));
+    });
+
+    ASSERT_EQ(10, ids.size());
+    ASSERT_EQ(10, initialized);
+    ASSERT_EQ(10, world.getEntities().size());
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        ECSE::Entity* e = world.getEntity(ids[i]);
+        ASSERT_NE(nullptr, e);
+        ASSERT_EQ(float(i), e->getComponent<ECSE::TransformComponent>()->getLocalPosition().x);
+
+        // Base types are attached too
+        ASSERT_EQ(e->getComponent<TestComponentChild>(), e->getComponent<TestComponentBase>());
+
+        // The Entities are already registered
+        ASSERT_THROW(world.attachComponent<DummyComponent>(ids[i]), std::runtime_error);
+    }
+
+    // Systems are only asked about Entities matching their signature
+    world.createEntities<DummyComponent>(5);
+    world.update(sf::Time::Zero);
+
+    ASSERT_EQ(10, sys->checks);
+    ASSERT_EQ(10, sys->getEntities().size());
+    ASSERT_EQ(15, world.getEntities().size());
+}
+
+TEST_F(WorldTest, TestCreateEntitiesWithoutComponents)
+{
+    // Without Component types, this is EntityManager::createEntities whichever way it's called
+    auto ids = world.createEntities(2);
+    ECSE::EntityManager& manager = world;
+    auto moreIds = manager.createEntities(2);
+    ids.insert(ids.end(), moreIds.begin(), moreIds.end());
+
+    for (auto id : ids)
+    {
+        // The Entities aren't registered yet
+        ASSERT_NE(nullptr, world.attachComponent<DummyComponent>(id));
+    }
+
+    for (auto id : ids)
+    {
+        world.registerEntity(id);
+    }
+    world.update(sf::Time::Zero);
+
+    ASSERT_EQ(4, world.view<DummyComponent>().size());
+}